@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "archive.hpp"
+#include "parse.hpp"
+
+static const char archive_magic[4] = { 'W', 'C', 'A', 'R' };
+static const char archive_version = 1;
+
+static std::uint64_t zigzag(std::int64_t n) {
+    return (static_cast<std::uint64_t>(n) << 1) ^ static_cast<std::uint64_t>(n >> 63);
+}
+
+static std::int64_t unzigzag(std::uint64_t n) {
+    return static_cast<std::int64_t>(n >> 1) ^ -static_cast<std::int64_t>(n & 1);
+}
+
+// Times are kept as their printed fields, which truncate to hundredths:
+// rounding the float instead would print 12:34.57 back for 12:34.567.
+static std::int64_t centiseconds(const Time &time) {
+    return time.get_minutes() * 6000ll + time.get_seconds() * 100 + time.get_ms();
+}
+
+static Time from_centiseconds(std::int64_t time) {
+    return Time(static_cast<int>(time / 6000), static_cast<int>(time / 100 % 60), static_cast<int>(time % 100));
+}
+
+static void put_string(std::string &out, const std::string &s) {
+    put_varint(out, s.size());
+    out += s;
+}
+
+static bool get_string(const char *&p, const char *end, std::string &s) {
+    std::uint64_t length;
+    if (!get_varint(p, end, length) || length > static_cast<std::uint64_t>(end - p)) {
+        return false;
+    }
+    s.assign(p, length);
+    p += length;
+    return true;
+}
+
+bool ArchiveWriter::add_race(const std::string &label,
+        const Rosters &rosters, const Teams &teams, const Runners &runners,
+        const Finishes &finishes, const Results &results) {
+
+    // checked before anything is written, so a bad race leaves no trace
+    for (std::size_t i = 0; i < finishes.size(); i++) {
+        const auto runner_id = finishes[i].runner_id;
+        const auto team_id = rosters.runner_to_team.find(runner_id);
+        if (!runners.count(runner_id) || team_id == rosters.runner_to_team.end() || !teams.count(team_id->second)) {
+            std::cerr << "ArchiveWriter::add_race(): \"" << label << "\" finish #" << i + 1
+                << " runner \"" << runner_id << "\" is not on the roster\n";
+            return false;
+        }
+    }
+    for (auto &result : results) {
+        if (!teams.count(result.team_id)) {
+            std::cerr << "ArchiveWriter::add_race(): \"" << label << "\" team \"" << result.team_id
+                << "\" is not on the roster\n";
+            return false;
+        }
+    }
+
+    auto team = [&] (TeamId team_id) {
+        const auto &initials = teams.find(team_id)->second.initials;
+        auto found = team_index.find(initials);
+        if (found != team_index.end()) {
+            return found->second;
+        }
+        const auto index = static_cast<std::uint32_t>(team_initials.size());
+        team_index[initials] = index;
+        team_initials.push_back(initials);
+        return index;
+    };
+
+    ArchiveRace race;
+    race.label = label;
+    race.offset = blocks.size();
+    race.finish_count = finishes.size();
+    race.result_count = results.size();
+
+    std::int64_t last_time = 0;
+    for (auto &finish : finishes) {
+        auto found = runner_index.find(finish.runner_id);
+        if (found == runner_index.end()) {
+            const auto index = static_cast<std::uint32_t>(runner_ids.size());
+            found = runner_index.insert(std::make_pair(finish.runner_id, index)).first;
+            runner_ids.push_back(finish.runner_id);
+            this->runners.push_back(runners.find(finish.runner_id)->second);
+            runner_teams.push_back(team(rosters.runner_to_team.find(finish.runner_id)->second));
+        }
+        const auto time = centiseconds(finish.time);
+        put_varint(blocks, found->second);
+        put_varint(blocks, zigzag(time - last_time));
+        put_varint(blocks, finish.score);
+        last_time = time;
+    }
+
+    unsigned int last_place = 0;
+    for (auto &result : results) {
+        put_varint(blocks, team(result.team_id));
+        put_varint(blocks, result.place - last_place);
+        put_varint(blocks, result.squad.score);
+        put_varint(blocks, centiseconds(result.squad.time));
+        put_varint(blocks, result.squad.places.size());
+        unsigned int last_number = 0;
+        for (auto &place : result.squad.places) {
+            put_varint(blocks, place.place_number - last_number);
+            last_number = place.place_number;
+        }
+        last_place = result.place;
+    }
+
+    race.length = blocks.size() - race.offset;
+    races.push_back(race);
+    return true;
+}
+
+bool ArchiveWriter::add_meet(const std::string &label, const Wildcat &w) {
+    switch (w.heat.tag) {
+    case Heat::Tag::Single:
+        return add_race(label, w.rosters, w.teams, w.runners, *w.heat.single.finishes, *w.heat.single.results);
+    case Heat::Tag::Combined:
+        return add_race(label + " Varsity", w.rosters, w.teams, w.runners,
+                *w.heat.combined.varsity_finishes, *w.heat.combined.varsity_results) &&
+            add_race(label + " JV", w.rosters, w.teams, w.runners,
+                *w.heat.combined.jv_finishes, *w.heat.combined.jv_results);
+    }
+    return false;
+}
+
+bool ArchiveWriter::save(const std::string &archive_file) const {
+    std::string out(archive_magic, sizeof archive_magic);
+    out.push_back(archive_version);
+
+    put_varint(out, team_initials.size());
+    for (auto &initials : team_initials) {
+        put_string(out, initials);
+    }
+    put_varint(out, runner_ids.size());
+    for (std::size_t i = 0; i < runner_ids.size(); i++) {
+        const auto &runner = runners[i];
+        put_varint(out, zigzag(runner_ids[i]));
+        put_string(out, runner.name);
+        put_varint(out, runner.klass ? 9 + static_cast<int>(*runner.klass) : 0);
+        put_varint(out, runner.gender ? 1 + static_cast<int>(*runner.gender) : 0);
+        put_varint(out, runner_teams[i]);
+    }
+
+    const auto base = out.size();
+    out += blocks;
+
+    const std::uint64_t index_offset = out.size();
+    put_varint(out, races.size());
+    for (auto &race : races) {
+        put_string(out, race.label);
+        put_varint(out, base + race.offset);
+        put_varint(out, race.length);
+        put_varint(out, race.finish_count);
+        put_varint(out, race.result_count);
+    }
+    char footer[sizeof index_offset];
+    std::memcpy(footer, &index_offset, sizeof index_offset);
+    out.append(footer, sizeof footer);
+    out.append(archive_magic, sizeof archive_magic);
+
+    std::ofstream file(archive_file, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ArchiveWriter::save(): Can't open \"" << archive_file << "\"\n";
+        return false;
+    }
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+bool load_archive(const std::string &archive_file, Archive &archive) {
+
+    archive.runners.clear();
+    archive.rosters.runner_to_team.clear();
+    archive.rosters.team_to_runners.clear();
+    archive.teams.clear();
+    archive.races.clear();
+    archive.runner_ids.clear();
+
+    auto &in = archive.contents;
+    if (!read_file(archive_file, in)) {
+        std::cerr << "load_archive(): No file \"" << archive_file << "\"\n";
+        return false;
+    }
+
+    auto corrupt = [&] () {
+        std::cerr << "load_archive() with \"" << archive_file << "\": not an archive or truncated\n";
+        return false;
+    };
+    const auto footer = sizeof(std::uint64_t) + sizeof archive_magic;
+    if (in.size() < sizeof archive_magic + 1 + footer ||
+        !std::equal(archive_magic, archive_magic + sizeof archive_magic, in.begin()) ||
+        in[sizeof archive_magic] != archive_version ||
+        !std::equal(archive_magic, archive_magic + sizeof archive_magic, in.end() - sizeof archive_magic)) {
+        return corrupt();
+    }
+    std::uint64_t index_offset;
+    std::memcpy(&index_offset, in.data() + in.size() - footer, sizeof index_offset);
+    if (index_offset > in.size() - footer) {
+        return corrupt();
+    }
+
+    const char *p = in.data() + sizeof archive_magic + 1;
+    const char *end = in.data() + index_offset;
+    std::uint64_t count;
+    if (!get_varint(p, end, count)) {
+        return corrupt();
+    }
+    for (std::uint64_t i = 0; i < count; i++) {
+        Team team;
+        if (!get_string(p, end, team.initials)) {
+            return corrupt();
+        }
+        archive.teams.insert(std::pair<TeamId, Team>(i, team));
+        archive.rosters.team_to_runners.insert(std::pair<TeamId, std::vector<RunnerId>>(i, {}));
+    }
+    if (!get_varint(p, end, count)) {
+        return corrupt();
+    }
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::uint64_t id, grade, gender, team;
+        Runner runner;
+        if (!get_varint(p, end, id) || !get_string(p, end, runner.name) ||
+            !get_varint(p, end, grade) || !get_varint(p, end, gender) || !get_varint(p, end, team) ||
+            team >= archive.teams.size()) {
+            return corrupt();
+        }
+        if (grade >= 9 && grade <= 12) {
+            runner.klass = static_cast<Class>(grade - 9);
+        }
+        if (gender == 1 || gender == 2) {
+            runner.gender = static_cast<Gender>(gender - 1);
+        }
+        const auto runner_id = static_cast<RunnerId>(unzigzag(id));
+        archive.runner_ids.push_back(runner_id);
+        archive.runners.insert(std::pair<RunnerId, Runner>(runner_id, runner));
+        archive.rosters.runner_to_team.insert(std::pair<RunnerId, TeamId>(runner_id, team));
+        archive.rosters.team_to_runners[team].push_back(runner_id);
+    }
+
+    p = in.data() + index_offset;
+    end = in.data() + in.size() - footer;
+    if (!get_varint(p, end, count)) {
+        return corrupt();
+    }
+    for (std::uint64_t i = 0; i < count; i++) {
+        ArchiveRace race;
+        std::uint64_t offset, length, finishes, results;
+        if (!get_string(p, end, race.label) || !get_varint(p, end, offset) || !get_varint(p, end, length) ||
+            !get_varint(p, end, finishes) || !get_varint(p, end, results) ||
+            offset > index_offset || length > index_offset - offset) {
+            return corrupt();
+        }
+        race.offset = offset;
+        race.length = length;
+        race.finish_count = finishes;
+        race.result_count = results;
+        archive.races.push_back(race);
+    }
+    return true;
+}
+
+bool read_race(const Archive &archive, std::size_t race_number, Finishes &finishes, Results &results) {
+
+    finishes.clear();
+    results.clear();
+
+    if (race_number >= archive.races.size()) {
+        return false;
+    }
+    const auto &race = archive.races[race_number];
+    const char *p = archive.contents.data() + race.offset;
+    const char *end = p + race.length;
+
+    finishes.resize(race.finish_count);
+    std::int64_t time = 0;
+    for (auto &finish : finishes) {
+        std::uint64_t runner, gap, score;
+        if (!get_varint(p, end, runner) || !get_varint(p, end, gap) || !get_varint(p, end, score) ||
+            runner >= archive.runner_ids.size()) {
+            return false;
+        }
+        time += unzigzag(gap);
+        finish.runner_id = archive.runner_ids[runner];
+        finish.time = from_centiseconds(time);
+        finish.score = score;
+    }
+
+    results.resize(race.result_count);
+    unsigned int place = 0;
+    for (auto &result : results) {
+        std::uint64_t team, place_gap, score, squad_time, count;
+        if (!get_varint(p, end, team) || !get_varint(p, end, place_gap) || !get_varint(p, end, score) ||
+            !get_varint(p, end, squad_time) || !get_varint(p, end, count) ||
+            count > finishes.size()) {
+            return false;
+        }
+        place += place_gap;
+        result.place = place;
+        result.team_id = team;
+        result.squad.score = score;
+        result.squad.time = from_centiseconds(squad_time);
+        result.squad.places.resize(count);
+        unsigned int number = 0;
+        for (auto &entry : result.squad.places) {
+            std::uint64_t gap;
+            if (!get_varint(p, end, gap) || number + gap == 0 || number + gap > finishes.size()) {
+                return false;
+            }
+            number += gap;
+            entry.place_number = number;
+            entry.runner_id = finishes[number - 1].runner_id;
+        }
+    }
+    return true;
+}
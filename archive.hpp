@@ -0,0 +1,70 @@
+#ifndef ARCHIVE_HPP
+#define ARCHIVE_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// Years of meets in one file, a few bytes per finish.
+//
+//   "WCAR", version
+//   dictionary  every runner once (bib, name, grade, gender, team) and
+//               every team once (initials); runners and teams are then
+//               referred to by their dense index in it
+//   races       per race: finishes as varint dense runner ids, varint
+//               centisecond gaps from the previous finish and varint
+//               scores; team results as dense team ids, scores, squad
+//               times and place gaps
+//   index       per race: label, offset, length and counts
+//   footer      u64 offset of the index, "WCAR"
+//
+// Varints are LEB128 (see parse.hpp). A race decodes on its own, so the
+// index gives random access and a history query can skip races by label.
+
+struct ArchiveRace {
+    std::string label;
+    std::size_t offset;
+    std::size_t length;
+    std::size_t finish_count;
+    std::size_t result_count;
+};
+
+// Runners are keyed by bib: a runner who changes teams keeps the team
+// they were first archived with.
+class ArchiveWriter {
+public:
+    // False, with nothing added, if a finisher or a team isn't on the
+    // roster; a race that passed validate() always goes in.
+    bool add_race(const std::string &label,
+        const Rosters &rosters, const Teams &teams, const Runners &runners,
+        const Finishes &finishes, const Results &results);
+    bool add_meet(const std::string &label, const Wildcat &w);
+    bool save(const std::string &archive_file) const;
+
+private:
+    std::map<RunnerId, std::uint32_t> runner_index;
+    std::map<std::string, std::uint32_t> team_index;
+    std::vector<RunnerId> runner_ids;
+    std::vector<Runner> runners;
+    std::vector<std::uint32_t> runner_teams;
+    std::vector<std::string> team_initials;
+    std::vector<ArchiveRace> races;
+    std::string blocks;
+};
+
+// The dictionary comes back as Runners, Rosters and Teams with the dense
+// team index as TeamId, ready for output_results().
+struct Archive {
+    Runners runners;
+    Rosters rosters;
+    Teams teams;
+    std::vector<ArchiveRace> races;
+    std::vector<RunnerId> runner_ids;
+    std::string contents;
+};
+
+bool load_archive(const std::string &archive_file, Archive &archive);
+bool read_race(const Archive &archive, std::size_t race, Finishes &finishes, Results &results);
+
+#endif
@@ -0,0 +1,83 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "archive.hpp"
+
+// archive-check [scratch dir]
+//
+// Writes a race whose times aren't exact hundredths to an archive in the
+// scratch directory (/tmp by default), reads it back, and fails unless
+// every finish and squad time prints the same as before.
+
+static std::string printed(const Time &time) {
+    std::ostringstream ss;
+    ss << time;
+    return ss.str();
+}
+
+int main(int argc, char **argv) {
+    const std::string archive_file = std::string(argc > 1 ? argv[1] : "/tmp") + "/archive_check.wcar";
+
+    Rosters rosters;
+    Teams teams;
+    Runners runners;
+    const TeamId team_count = 8;
+    const RunnerId runner_count = 400;
+    for (TeamId team_id = 0; team_id < team_count; team_id++) {
+        teams[team_id].initials = "T" + std::to_string(team_id);
+        rosters.team_to_runners[team_id];
+    }
+    std::mt19937 random(42);
+    for (RunnerId runner_id = 1000; runner_id < 1000 + runner_count; runner_id++) {
+        const TeamId team_id = random() % team_count;
+        rosters.runner_to_team[runner_id] = team_id;
+        rosters.team_to_runners[team_id].push_back(runner_id);
+        runners[runner_id].name = "Runner " + std::to_string(runner_id);
+    }
+
+    // thousandths, and the edges of a hundredth, a second and a minute
+    Finishes finishes;
+    const float edges[] = { 59.999f, 754.567f, 0.009f, 1199.995f, 900.005f, 119.99f };
+    for (auto seconds : edges) {
+        finishes.push_back({ static_cast<RunnerId>(1000 + finishes.size()), Time(seconds), 0 });
+    }
+    std::uniform_int_distribution<int> thousandths(0, 2000000);
+    for (auto runner_id = static_cast<RunnerId>(1000 + finishes.size()); runner_id < 1000 + runner_count; runner_id++) {
+        finishes.push_back({ runner_id, Time(thousandths(random) / 1000.0f), 0 });
+    }
+    Results results;
+    score_race(runners, teams, rosters, finishes, results);
+
+    ArchiveWriter writer;
+    Archive archive;
+    Finishes read_finishes;
+    Results read_results;
+    if (!writer.add_race("check", rosters, teams, runners, finishes, results) ||
+        !writer.save(archive_file) || !load_archive(archive_file, archive) ||
+        !read_race(archive, 0, read_finishes, read_results)) {
+        std::cerr << "archive-check: can't round-trip \"" << archive_file << "\"\n";
+        return EXIT_FAILURE;
+    }
+
+    unsigned int differ = 0;
+    for (std::size_t i = 0; i < finishes.size() && i < read_finishes.size(); i++) {
+        if (printed(finishes[i].time) != printed(read_finishes[i].time)) {
+            std::cerr << "archive-check: finish " << i << " (" << finishes[i].time.get_total_seconds() << " s) was "
+                << finishes[i].time << ", read back " << read_finishes[i].time << '\n';
+            differ++;
+        }
+    }
+    for (std::size_t i = 0; i < results.size() && i < read_results.size(); i++) {
+        if (printed(results[i].squad.time) != printed(read_results[i].squad.time)) {
+            std::cerr << "archive-check: squad " << i << " was " << results[i].squad.time
+                << ", read back " << read_results[i].squad.time << '\n';
+            differ++;
+        }
+    }
+    if (differ || finishes.size() != read_finishes.size() || results.size() != read_results.size()) {
+        return EXIT_FAILURE;
+    }
+    std::cout << finishes.size() << " finishes and " << results.size() << " squads read back as written\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "athletes.hpp"
+
+static const char db_magic[5] = { 'W', 'C', 'A', 'D', 'B' };
+static const std::uint8_t db_version = 2;
+static const std::uint16_t empty_slot = 0xffff; // in AthleteRecord::team
+
+struct DbHeader {
+    char magic[5];
+    std::uint8_t version;
+    std::uint16_t reserved;
+    std::uint32_t athlete_count; // slots, a few more than runners
+    std::uint32_t team_count;
+    std::uint32_t bucket_count;
+    std::uint32_t strings_length;
+    std::uint32_t member_count;
+    std::uint32_t reserved2;
+    std::uint64_t seeds_offset;
+    std::uint64_t athletes_offset;
+    std::uint64_t teams_offset;
+    std::uint64_t members_offset;
+    std::uint64_t strings_offset;
+};
+
+static std::uint64_t hash(RunnerId runner_id, std::uint32_t seed) {
+    // splitmix64
+    auto x = static_cast<std::uint32_t>(runner_id) ^ (seed * 0x9e3779b97f4a7c15ull);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+AthleteDb::AthleteDb()
+: data(nullptr)
+, length(0)
+, athlete_count(0)
+, team_count(0)
+, bucket_count(0)
+, seeds(nullptr)
+, athletes(nullptr)
+, teams(nullptr)
+, member_count(0)
+, team_members(nullptr)
+, strings(nullptr)
+{
+}
+
+AthleteDb::~AthleteDb() {
+    close();
+}
+
+bool AthleteDb::open(const std::string &db_file) {
+    close();
+
+    const int fd = ::open(db_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "AthleteDb::open(): No file \"" << db_file << "\"\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(DbHeader)) {
+        std::cerr << "AthleteDb::open() with \"" << db_file << "\": not an athlete database\n";
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "AthleteDb::open() with \"" << db_file << "\": can't map\n";
+        return false;
+    }
+    data = static_cast<const unsigned char *>(mapped);
+    length = st.st_size;
+
+    DbHeader header;
+    std::memcpy(&header, data, sizeof header);
+    const auto fits = [&] (std::uint64_t offset, std::uint64_t bytes) {
+        return offset <= length && bytes <= length - offset;
+    };
+    if (!std::equal(db_magic, db_magic + sizeof db_magic, header.magic) ||
+        header.version != db_version ||
+        header.bucket_count == 0 || header.athlete_count == 0 ||
+        !fits(header.seeds_offset, header.bucket_count * sizeof(std::uint32_t)) ||
+        !fits(header.athletes_offset, header.athlete_count * sizeof(AthleteRecord)) ||
+        !fits(header.teams_offset, header.team_count * sizeof(TeamRecord)) ||
+        !fits(header.members_offset, header.member_count * sizeof(std::uint32_t)) ||
+        !fits(header.strings_offset, header.strings_length)) {
+        std::cerr << "AthleteDb::open() with \"" << db_file << "\": not an athlete database\n";
+        close();
+        return false;
+    }
+
+    athlete_count = header.athlete_count;
+    team_count = header.team_count;
+    bucket_count = header.bucket_count;
+    seeds = reinterpret_cast<const std::uint32_t *>(data + header.seeds_offset);
+    athletes = reinterpret_cast<const AthleteRecord *>(data + header.athletes_offset);
+    teams = reinterpret_cast<const TeamRecord *>(data + header.teams_offset);
+    member_count = header.member_count;
+    team_members = reinterpret_cast<const std::uint32_t *>(data + header.members_offset);
+    strings = reinterpret_cast<const char *>(data + header.strings_offset);
+    return true;
+}
+
+void AthleteDb::close() {
+    if (data) {
+        munmap(const_cast<unsigned char *>(data), length);
+    }
+    data = nullptr;
+    length = 0;
+    athlete_count = 0;
+    team_count = 0;
+    bucket_count = 0;
+    member_count = 0;
+}
+
+const AthleteRecord *AthleteDb::find(RunnerId runner_id) const {
+    if (!data) {
+        return nullptr;
+    }
+    const auto seed = seeds[hash(runner_id, 0) % bucket_count];
+    const auto &athlete = athletes[hash(runner_id, seed) % athlete_count];
+    // the hash is only perfect for ids that are in the database
+    if (athlete.team == empty_slot || athlete.runner_id != runner_id) {
+        return nullptr;
+    }
+    return &athlete;
+}
+
+std::string AthleteDb::name(const AthleteRecord &athlete) const {
+    return std::string(strings + athlete.name_offset, athlete.name_length);
+}
+
+std::string AthleteDb::initials(std::uint16_t team) const {
+    if (team >= team_count) {
+        return "";
+    }
+    return std::string(strings + teams[team].initials_offset, teams[team].initials_length);
+}
+
+bool AthleteDb::find_team(const std::string &initials, std::uint16_t &team) const {
+    for (std::uint32_t t = 0; t < team_count; t++) {
+        if (teams[t].initials_length == initials.size() &&
+            std::equal(initials.begin(), initials.end(), strings + teams[t].initials_offset)) {
+            team = static_cast<std::uint16_t>(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+void AthleteDb::members(std::uint16_t team, std::vector<const AthleteRecord *> &athletes) const {
+    athletes.clear();
+    if (team >= team_count) {
+        return;
+    }
+    const auto &record = teams[team];
+    if (record.first_member > member_count || record.member_count > member_count - record.first_member) {
+        return;
+    }
+    for (std::uint32_t i = 0; i < record.member_count; i++) {
+        const auto slot = team_members[record.first_member + i];
+        if (slot < athlete_count && this->athletes[slot].team == team) {
+            athletes.push_back(&this->athletes[slot]);
+        }
+    }
+}
+
+std::size_t AthleteDb::size() const {
+    return athlete_count;
+}
+
+bool build_athlete_db(const std::string &roster_file, const std::string &db_file) {
+    Rosters rosters;
+    Teams teams;
+    Runners runners;
+    if (!import_rosters_v2(roster_file, rosters, teams, runners)) {
+        return false;
+    }
+    if (runners.empty() || teams.size() >= empty_slot) {
+        std::cerr << "build_athlete_db() with \"" << roster_file << "\": "
+            << runners.size() << " runners on " << teams.size() << " teams won't fit\n";
+        return false;
+    }
+
+    // hash and displace: ids go to buckets of ~4, then the fullest buckets
+    // pick a seed first that lands all their ids in free slots
+    const auto n = runners.size();
+    DbHeader header;
+    std::memcpy(header.magic, db_magic, sizeof db_magic);
+    header.version = db_version;
+    header.reserved = 0;
+    header.athlete_count = static_cast<std::uint32_t>(n + n / 8 + 1);
+    header.team_count = static_cast<std::uint32_t>(teams.size());
+    header.bucket_count = static_cast<std::uint32_t>(n / 4 + 1);
+
+    std::vector<std::vector<RunnerId>> buckets(header.bucket_count);
+    for (auto &runner : runners) {
+        buckets[hash(runner.first, 0) % header.bucket_count].push_back(runner.first);
+    }
+    std::vector<std::uint32_t> order(header.bucket_count);
+    for (std::uint32_t b = 0; b < header.bucket_count; b++) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&] (std::uint32_t a, std::uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<std::uint32_t> seeds(header.bucket_count, 1);
+    std::vector<bool> taken(header.athlete_count, false);
+    std::vector<RunnerId> slot_runner(header.athlete_count);
+    std::vector<std::uint32_t> slots;
+    for (auto b : order) {
+        const auto &bucket = buckets[b];
+        if (bucket.empty()) {
+            break;
+        }
+        std::uint32_t seed = 1;
+        for (;; seed++) {
+            if (seed == 0) {
+                std::cerr << "build_athlete_db() with \"" << roster_file << "\": no perfect hash\n";
+                return false;
+            }
+            slots.clear();
+            bool fits = true;
+            for (auto runner_id : bucket) {
+                const auto slot = static_cast<std::uint32_t>(hash(runner_id, seed) % header.athlete_count);
+                if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    fits = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (fits) {
+                break;
+            }
+        }
+        seeds[b] = seed;
+        for (std::size_t i = 0; i < bucket.size(); i++) {
+            taken[slots[i]] = true;
+            slot_runner[slots[i]] = bucket[i];
+        }
+    }
+
+    std::map<RunnerId, std::uint32_t> slot_of;
+    for (std::uint32_t slot = 0; slot < header.athlete_count; slot++) {
+        if (taken[slot]) {
+            slot_of[slot_runner[slot]] = slot;
+        }
+    }
+
+    std::string pool;
+    std::vector<TeamRecord> team_records(teams.size());
+    std::vector<std::uint32_t> members;
+    for (auto &team : teams) {
+        auto &record = team_records[team.first];
+        record.initials_offset = static_cast<std::uint32_t>(pool.size());
+        record.initials_length = static_cast<std::uint16_t>(team.second.initials.size());
+        record.reserved = 0;
+        record.first_member = static_cast<std::uint32_t>(members.size());
+        auto roster = rosters.team_to_runners.find(team.first);
+        if (roster != rosters.team_to_runners.end()) {
+            for (auto runner_id : roster->second) {
+                members.push_back(slot_of[runner_id]);
+            }
+        }
+        record.member_count = static_cast<std::uint32_t>(members.size()) - record.first_member;
+        pool += team.second.initials;
+    }
+    header.member_count = static_cast<std::uint32_t>(members.size());
+    header.reserved2 = 0;
+    std::vector<AthleteRecord> athletes(header.athlete_count);
+    for (std::uint32_t slot = 0; slot < header.athlete_count; slot++) {
+        auto &athlete = athletes[slot];
+        std::memset(&athlete, 0, sizeof athlete);
+        if (!taken[slot]) {
+            athlete.team = empty_slot;
+            continue;
+        }
+        const auto runner_id = slot_runner[slot];
+        const auto &runner = runners.find(runner_id)->second;
+        const auto name_length = std::min<std::size_t>(runner.name.size(), 0xffff);
+        athlete.runner_id = runner_id;
+        athlete.name_offset = static_cast<std::uint32_t>(pool.size());
+        athlete.name_length = static_cast<std::uint16_t>(name_length);
+        athlete.team = static_cast<std::uint16_t>(rosters.runner_to_team.find(runner_id)->second);
+        athlete.grade = runner.klass ? 9 + static_cast<int>(*runner.klass) : 0;
+        athlete.gender = runner.gender ? (*runner.gender == Gender::F ? 'F' : 'M') : 0;
+        pool.append(runner.name, 0, name_length);
+    }
+    header.strings_length = static_cast<std::uint32_t>(pool.size());
+
+    header.seeds_offset = sizeof header;
+    header.athletes_offset = header.seeds_offset + seeds.size() * sizeof(std::uint32_t);
+    header.athletes_offset = (header.athletes_offset + 7) / 8 * 8;
+    header.teams_offset = header.athletes_offset + athletes.size() * sizeof(AthleteRecord);
+    header.members_offset = header.teams_offset + team_records.size() * sizeof(TeamRecord);
+    header.strings_offset = header.members_offset + members.size() * sizeof(std::uint32_t);
+
+    std::ofstream file(db_file, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "build_athlete_db(): Can't open \"" << db_file << "\"\n";
+        return false;
+    }
+    const char padding[8] = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof header);
+    file.write(reinterpret_cast<const char *>(seeds.data()), seeds.size() * sizeof(std::uint32_t));
+    file.write(padding, header.athletes_offset - header.seeds_offset - seeds.size() * sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char *>(athletes.data()), athletes.size() * sizeof(AthleteRecord));
+    file.write(reinterpret_cast<const char *>(team_records.data()), team_records.size() * sizeof(TeamRecord));
+    file.write(reinterpret_cast<const char *>(members.data()), members.size() * sizeof(std::uint32_t));
+    file.write(pool.data(), pool.size());
+    return static_cast<bool>(file);
+}
+
+bool materialize_rosters(const AthleteDb &db, const std::vector<std::string> &entries,
+    const std::vector<RunnerId> &barcodes, Rosters &rosters, Teams &teams, Runners &runners) {
+
+    rosters.runner_to_team.clear();
+    rosters.team_to_runners.clear();
+    teams.clear();
+    runners.clear();
+
+    std::set<std::uint16_t> entered;
+    bool ok = true;
+    for (auto &initials : entries) {
+        std::uint16_t team;
+        if (!db.find_team(initials, team)) {
+            std::cerr << "materialize_rosters(): team \"" << initials << "\" is not in the database\n";
+            ok = false;
+            continue;
+        }
+        entered.insert(team);
+    }
+    for (auto runner_id : barcodes) {
+        if (const auto *athlete = db.find(runner_id)) {
+            entered.insert(athlete->team);
+        }
+    }
+
+    // team by team in TeamId order, each in roster order, as
+    // import_rosters_v2 would have read them
+    std::vector<const AthleteRecord *> members;
+    for (auto team_id : entered) {
+        Team team;
+        team.initials = db.initials(team_id);
+        teams.insert(std::pair<TeamId, Team>(team_id, team));
+        auto &roster = rosters.team_to_runners[team_id];
+
+        db.members(team_id, members);
+        for (const auto *athlete : members) {
+            const RunnerId runner_id = athlete->runner_id;
+            Runner runner;
+            runner.name = db.name(*athlete);
+            if (athlete->grade >= 9 && athlete->grade <= 12) {
+                runner.klass = static_cast<Class>(athlete->grade - 9);
+            }
+            if (athlete->gender == 'F') {
+                runner.gender = Gender::F;
+            } else if (athlete->gender == 'M') {
+                runner.gender = Gender::M;
+            }
+            runners.insert(std::pair<RunnerId, Runner>(runner_id, runner));
+            rosters.runner_to_team.insert(std::pair<RunnerId, TeamId>(runner_id, team_id));
+            roster.push_back(runner_id);
+        }
+    }
+    return ok;
+}
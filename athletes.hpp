@@ -0,0 +1,81 @@
+#ifndef ATHLETES_HPP
+#define ATHLETES_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// The state association's whole athlete database, prebuilt from a roster
+// file and memory-mapped, so opening it costs nothing and a meet only
+// touches the pages of the runners it scans.
+//
+// Layout, native byte order:
+//   header    magic "WCADB", version, counts and section offsets
+//   seeds     u32 per bucket, a hash-and-displace perfect hash on RunnerId
+//   athletes  AthleteRecord per runner, in the slot the hash gives it
+//   teams     TeamRecord per team; the team's index is its TeamId
+//   members   u32 athlete slot per runner, grouped by team in roster order
+//   strings   names and initials, not terminated
+struct AthleteRecord {
+    std::int32_t runner_id;
+    std::uint32_t name_offset;
+    std::uint16_t name_length;
+    std::uint16_t team;
+    std::uint8_t grade;  // 9-12, 0 if unknown
+    std::uint8_t gender; // 'F', 'M' or 0
+};
+
+struct TeamRecord {
+    std::uint32_t initials_offset;
+    std::uint16_t initials_length;
+    std::uint16_t reserved;
+    std::uint32_t first_member; // into members
+    std::uint32_t member_count;
+};
+
+class AthleteDb {
+public:
+    AthleteDb();
+    ~AthleteDb();
+    AthleteDb(const AthleteDb &) = delete;
+    AthleteDb &operator=(const AthleteDb &) = delete;
+
+    bool open(const std::string &db_file);
+    void close();
+
+    // nullptr if the runner isn't in the database
+    const AthleteRecord *find(RunnerId runner_id) const;
+    std::string name(const AthleteRecord &athlete) const;
+    std::string initials(std::uint16_t team) const;
+    // false if no team has these initials
+    bool find_team(const std::string &initials, std::uint16_t &team) const;
+    // the team's whole roster, in roster order
+    void members(std::uint16_t team, std::vector<const AthleteRecord *> &athletes) const;
+    std::size_t size() const;
+
+private:
+    const unsigned char *data;
+    std::size_t length;
+    std::uint32_t athlete_count;
+    std::uint32_t team_count;
+    std::uint32_t bucket_count;
+    const std::uint32_t *seeds;
+    const AthleteRecord *athletes;
+    const TeamRecord *teams;
+    std::uint32_t member_count;
+    const std::uint32_t *team_members;
+    const char *strings;
+};
+
+bool build_athlete_db(const std::string &roster_file, const std::string &db_file);
+
+// Fills the meet's working set with every team entered (by initials) or
+// with a runner in `barcodes`, each with its whole roster, as if the meet's
+// roster file held just those teams. TeamIds are the database's, so they
+// stay the same from meet to meet. Barcodes not in the database are left
+// for validate(); an entered team the database doesn't have is an error.
+bool materialize_rosters(const AthleteDb &db, const std::vector<std::string> &entries,
+    const std::vector<RunnerId> &barcodes, Rosters &rosters, Teams &teams, Runners &runners);
+
+#endif
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include "categories.hpp"
+
+static const std::size_t gender_count = 2;
+static const std::size_t class_count = 4;
+
+static const char *gender_labels[gender_count] = { "Girls", "Boys" };
+static const char *class_labels[class_count] = { "Freshmen", "Sophomores", "Juniors", "Seniors" };
+static const char *class_gender_labels[class_count] = { "Freshman", "Sophomore", "Junior", "Senior" };
+
+// Category numbering: genders, grades, grades by gender, teams, then teams
+// by gender.
+static std::size_t gender_category(std::size_t gender) {
+    return gender;
+}
+
+static std::size_t class_category(std::size_t klass) {
+    return gender_count + klass;
+}
+
+static std::size_t gender_class_category(std::size_t gender, std::size_t klass) {
+    return gender_count + class_count + gender * class_count + klass;
+}
+
+static std::size_t team_category(std::size_t team) {
+    return gender_count + class_count + gender_count * class_count + team;
+}
+
+static std::size_t gender_team_category(std::size_t team_count, std::size_t gender, std::size_t team) {
+    return team_category(team_count) + gender * team_count + team;
+}
+
+static std::size_t team_index(const CategoryRankings &rankings, TeamId team_id) {
+    auto found = std::lower_bound(rankings.team_ids.begin(), rankings.team_ids.end(), team_id);
+    if (found == rankings.team_ids.end() || *found != team_id) {
+        return rankings.team_ids.size();
+    }
+    return found - rankings.team_ids.begin();
+}
+
+void rank_categories(const Rosters &rosters, const Teams &teams, const Runners &runners,
+        const Finishes &finishes, unsigned int limit, CategoryRankings &rankings) {
+
+    rankings.limit = limit;
+    rankings.team_ids.clear();
+    for (auto &team : teams) {
+        rankings.team_ids.push_back(team.first);
+    }
+    const auto team_count = rankings.team_ids.size();
+
+    auto &categories = rankings.categories;
+    categories.assign(gender_team_category(team_count, gender_count, 0), Category());
+    for (std::size_t g = 0; g < gender_count; g++) {
+        auto &category = categories[gender_category(g)];
+        category.gender = static_cast<Gender>(g);
+        category.label = gender_labels[g];
+    }
+    for (std::size_t c = 0; c < class_count; c++) {
+        auto &category = categories[class_category(c)];
+        category.klass = static_cast<Class>(c);
+        category.label = class_labels[c];
+        for (std::size_t g = 0; g < gender_count; g++) {
+            auto &both = categories[gender_class_category(g, c)];
+            both.gender = static_cast<Gender>(g);
+            both.klass = static_cast<Class>(c);
+            both.label = std::string(class_gender_labels[c]) + ' ' + gender_labels[g];
+        }
+    }
+    for (std::size_t t = 0; t < team_count; t++) {
+        const auto team_id = rankings.team_ids[t];
+        const auto &initials = teams.find(team_id)->second.initials;
+        auto &category = categories[team_category(t)];
+        category.team_id = team_id;
+        category.label = initials;
+        for (std::size_t g = 0; g < gender_count; g++) {
+            auto &both = categories[gender_team_category(team_count, g, t)];
+            both.gender = static_cast<Gender>(g);
+            both.team_id = team_id;
+            both.label = initials + ' ' + gender_labels[g];
+        }
+    }
+
+    rankings.counts.assign(categories.size(), 0);
+    rankings.places.resize(categories.size());
+    for (auto &places : rankings.places) {
+        places.clear();
+    }
+
+    auto *counts = rankings.counts.data();
+    auto add = [&] (std::size_t category, unsigned int overall, const Finish &finish) {
+        const auto place = ++counts[category];
+        if (place <= limit) {
+            rankings.places[category].push_back({ place, overall, finish.runner_id, finish.time });
+        }
+    };
+
+    unsigned int overall = 0;
+    for (auto &finish : finishes) {
+        overall++;
+        auto runner = runners.find(finish.runner_id);
+        if (runner == runners.end()) {
+            continue;
+        }
+        const auto &gender = runner->second.gender;
+        const auto &klass = runner->second.klass;
+        auto team = rosters.runner_to_team.find(finish.runner_id);
+        const auto t = team == rosters.runner_to_team.end() ? team_count : team_index(rankings, team->second);
+
+        if (gender) {
+            add(gender_category(static_cast<std::size_t>(*gender)), overall, finish);
+        }
+        if (klass) {
+            add(class_category(static_cast<std::size_t>(*klass)), overall, finish);
+        }
+        if (gender && klass) {
+            add(gender_class_category(static_cast<std::size_t>(*gender), static_cast<std::size_t>(*klass)), overall, finish);
+        }
+        if (t < team_count) {
+            add(team_category(t), overall, finish);
+            if (gender) {
+                add(gender_team_category(team_count, static_cast<std::size_t>(*gender), t), overall, finish);
+            }
+        }
+    }
+}
+
+std::size_t find_category(const CategoryRankings &rankings,
+        optional<Gender> gender, optional<Class> klass, optional<TeamId> team_id) {
+
+    const auto team_count = rankings.team_ids.size();
+    const auto none = rankings.categories.size();
+    if (team_id) {
+        const auto t = team_index(rankings, *team_id);
+        if (klass || t == team_count) {
+            return none;
+        }
+        return gender ? gender_team_category(team_count, static_cast<std::size_t>(*gender), t)
+            : team_category(t);
+    }
+    if (gender && klass) {
+        return gender_class_category(static_cast<std::size_t>(*gender), static_cast<std::size_t>(*klass));
+    }
+    if (gender) {
+        return gender_category(static_cast<std::size_t>(*gender));
+    }
+    if (klass) {
+        return class_category(static_cast<std::size_t>(*klass));
+    }
+    return none;
+}
+
+void output_category(std::ostream &os, const CategoryRankings &rankings, std::size_t category,
+        const Rosters &rosters, const Teams &teams, const Runners &runners) {
+
+    os << '\n';
+    os << rankings.categories[category].label << " (" << rankings.counts[category] << " finished)\n";
+    os << "==================================================================================\n";
+    os << '\n';
+    os << "Place  Overall  Team             Name                              Grade  Time\n";
+    os << "----------------------------------------------------------------------------------\n";
+
+    std::stringstream ss;
+    auto extend = [&] (unsigned int limit) {
+        for (auto i = static_cast<unsigned int>(ss.tellp()); i < limit; i++) {
+            ss << ' ';
+        }
+    };
+    for (auto &place : rankings.places[category]) {
+        const auto &runner = runners.find(place.runner_id)->second;
+        ss.str("");
+        ss << place.place;
+        extend(7);
+        ss << place.overall;
+        extend(16);
+        // runners without a team still place by gender and grade
+        auto team_id = rosters.runner_to_team.find(place.runner_id);
+        if (team_id != rosters.runner_to_team.end()) {
+            auto team = teams.find(team_id->second);
+            if (team != teams.end()) {
+                ss << team->second.initials;
+            }
+        }
+        extend(33);
+        ss << runner.name;
+        extend(67);
+        if (runner.klass) {
+            ss << *runner.klass;
+        }
+        extend(74);
+        ss << place.time;
+        os << ss.str() << '\n';
+    }
+}
+
+void output_categories(std::ostream &os, const CategoryRankings &rankings,
+        const Rosters &rosters, const Teams &teams, const Runners &runners) {
+    for (std::size_t category = 0; category < rankings.categories.size(); category++) {
+        if (rankings.counts[category]) {
+            output_category(os, rankings, category, rosters, teams, runners);
+        }
+    }
+    output_results_footer(os);
+}
+
+void output_awards(std::ostream &os, const Wildcat &w, unsigned int limit) {
+    CategoryRankings rankings;
+    auto race = [&] (const char *title, const Finishes &finishes) {
+        rank_categories(w.rosters, w.teams, w.runners, finishes, limit, rankings);
+        os << '\n' << title << " AWARDS\n";
+        output_categories(os, rankings, w.rosters, w.teams, w.runners);
+    };
+    switch (w.heat.tag) {
+    case Heat::Tag::Single:
+        race("RACE", *w.heat.single.finishes);
+        break;
+    case Heat::Tag::Combined:
+        race("VARSITY", *w.heat.combined.varsity_finishes);
+        race("JV", *w.heat.combined.jv_finishes);
+        break;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef CATEGORIES_HPP
+#define CATEGORIES_HPP
+
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// Award categories: girls and boys, each grade, each grade of each gender,
+// each team and each gender of each team. An unset field matches anyone.
+struct Category {
+    optional<Gender> gender;
+    optional<Class> klass;
+    optional<TeamId> team_id;
+    std::string label;
+};
+
+struct CategoryPlace {
+    unsigned int place;   // within the category
+    unsigned int overall; // in the race
+    RunnerId runner_id;
+    Time time;
+};
+
+// Every category's places from one walk of the finish order. Categories
+// are numbered densely, so a finish bumps a handful of counters by index;
+// only the first `limit` places of each category are kept.
+struct CategoryRankings {
+    std::vector<Category> categories;
+    std::vector<unsigned int> counts; // finishers per category
+    std::vector<std::vector<CategoryPlace>> places;
+    std::vector<TeamId> team_ids; // a team's index in its categories
+    unsigned int limit = 0;
+};
+
+// `finishes` in finish order, as score_race() leaves them.
+void rank_categories(const Rosters &rosters, const Teams &teams, const Runners &runners,
+    const Finishes &finishes, unsigned int limit, CategoryRankings &rankings);
+
+// The category's index, or categories.size() if there's no such category.
+std::size_t find_category(const CategoryRankings &rankings,
+    optional<Gender> gender, optional<Class> klass, optional<TeamId> team_id);
+
+void output_category(std::ostream &os, const CategoryRankings &rankings, std::size_t category,
+    const Rosters &rosters, const Teams &teams, const Runners &runners);
+// every category with a finisher
+void output_categories(std::ostream &os, const CategoryRankings &rankings,
+    const Rosters &rosters, const Teams &teams, const Runners &runners);
+
+// Awards for every race of the heat, the first `limit` of each category.
+void output_awards(std::ostream &os, const Wildcat &w, unsigned int limit);
+
+#endif
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include "chutes.hpp"
+
+static long hundredths(float seconds) {
+    return std::lround(seconds * 100);
+}
+
+Chute::Chute(std::size_t capacity)
+: times(capacity)
+, barcodes(capacity)
+, clock(0)
+, closed(false)
+{}
+
+bool Chute::push_time(float seconds) {
+    if (!times.push(seconds)) {
+        return false;
+    }
+    tick(seconds);
+    return true;
+}
+
+void Chute::tick(float seconds) {
+    if (seconds > clock.load(std::memory_order_relaxed)) {
+        clock.store(seconds, std::memory_order_release);
+    }
+}
+
+void Chute::close() {
+    closed.store(true, std::memory_order_release);
+}
+
+bool Chute::push_barcode(RunnerId runner_id) {
+    return barcodes.push(runner_id);
+}
+
+void ChuteMerger::ChuteDeleter::operator()(Chute *chute) const {
+    chute->~Chute();
+    std::free(chute);
+}
+
+ChuteMerger::ChuteMerger(std::size_t chutes, std::size_t capacity)
+: pending(chutes)
+{
+    for (std::size_t i = 0; i < chutes; i++) {
+        void *memory = nullptr;
+        if (posix_memalign(&memory, alignof(Chute), sizeof(Chute)) != 0) {
+            throw std::bad_alloc();
+        }
+        std::unique_ptr<Chute, ChuteDeleter> chute(new (memory) Chute(capacity));
+        this->chutes.push_back(std::move(chute));
+    }
+}
+
+Chute &ChuteMerger::chute(std::size_t i) {
+    return *chutes[i];
+}
+
+std::size_t ChuteMerger::merge(Finishes &finishes) {
+    const auto n = chutes.size();
+
+    // Read the clocks before draining: anything a timer pushed before a
+    // tick we saw is then guaranteed to be in its queue below.
+    for (std::size_t i = 0; i < n; i++) {
+        pending[i].closed = chutes[i]->closed.load(std::memory_order_acquire);
+        pending[i].clock = chutes[i]->clock.load(std::memory_order_acquire);
+    }
+    for (std::size_t i = 0; i < n; i++) {
+        float seconds;
+        while (chutes[i]->times.pop(seconds)) {
+            pending[i].times.push_back(seconds);
+        }
+        RunnerId runner_id;
+        while (chutes[i]->barcodes.pop(runner_id)) {
+            pending[i].barcodes.push_back(runner_id);
+        }
+    }
+
+    std::size_t added = 0;
+    for (;;) {
+        // earliest finish that has both its time and its barcode
+        auto best = n;
+        long best_time = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            const auto &p = pending[i];
+            if (p.times.empty() || p.barcodes.empty()) {
+                continue;
+            }
+            const auto t = hundredths(p.times.front());
+            if (best == n || t < best_time) {
+                best = i;
+                best_time = t;
+            }
+        }
+        if (best == n) {
+            break;
+        }
+
+        // could any other chute still deliver something that goes first?
+        bool ready = true;
+        for (std::size_t i = 0; i < n && ready; i++) {
+            const auto &p = pending[i];
+            if (i == best) {
+                continue;
+            }
+            if (!p.times.empty()) {
+                if (p.closed && p.barcodes.empty()) {
+                    continue; // those times will never get a runner
+                }
+                const auto t = hundredths(p.times.front());
+                ready = t > best_time || (t == best_time && i > best);
+            } else if (!p.closed) {
+                const auto t = hundredths(p.clock);
+                ready = t > best_time || (t == best_time && i > best);
+            }
+        }
+        if (!ready) {
+            break;
+        }
+
+        auto &p = pending[best];
+        finishes.push_back({ p.barcodes.front(), Time(p.times.front()), 0 });
+        p.times.pop_front();
+        p.barcodes.pop_front();
+        added++;
+    }
+
+    return added;
+}
@@ -0,0 +1,113 @@
+#ifndef CHUTES_HPP
+#define CHUTES_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "wildcat.hpp"
+
+// Bounded lock-free ring for exactly one producer and one consumer thread.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity)
+    : slots(round_up(capacity))
+    , mask(slots.size() - 1)
+    , head(0)
+    , tail(0)
+    {}
+
+    bool push(const T &value) {
+        const auto t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value) {
+        const auto h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static std::size_t round_up(std::size_t n) {
+        std::size_t size = 1;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> slots;
+    const std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+};
+
+// One finish chute: its timer and its barcode scanner each push from their
+// own thread. Within a chute, the nth time belongs to the nth barcode.
+class Chute {
+public:
+    explicit Chute(std::size_t capacity);
+
+    // timer thread; tick() advances the chute's clock with no finish, and
+    // close() is called once both the timer and the scanner are done
+    bool push_time(float seconds);
+    void tick(float seconds);
+    void close();
+
+    // scanner thread
+    bool push_barcode(RunnerId runner_id);
+
+private:
+    friend class ChuteMerger;
+    SpscQueue<float> times;
+    SpscQueue<RunnerId> barcodes;
+    std::atomic<float> clock;
+    std::atomic<bool> closed;
+};
+
+// Merges every chute into one time-ordered Finishes sequence. A finish is
+// only released once no chute can still produce an earlier one: each other
+// chute must have a later time pending, or its timer's clock must have
+// passed, or it must be closed. Finishes in the same hundredth go in chute
+// order, then in the order that chute saw them.
+class ChuteMerger {
+public:
+    explicit ChuteMerger(std::size_t chutes, std::size_t capacity = 4096);
+
+    Chute &chute(std::size_t i);
+
+    // consumer thread; appends newly ordered finishes, returns how many
+    std::size_t merge(Finishes &finishes);
+
+private:
+    // Chute's queue indexes sit on their own cache lines, an alignment plain
+    // new doesn't honour before C++17; chutes are placed in memory from
+    // posix_memalign instead, and this puts them back.
+    struct ChuteDeleter {
+        void operator()(Chute *chute) const;
+    };
+
+    struct Pending {
+        std::deque<float> times;
+        std::deque<RunnerId> barcodes;
+        float clock = 0;
+        bool closed = false;
+    };
+
+    std::vector<std::unique_ptr<Chute, ChuteDeleter>> chutes;
+    std::vector<Pending> pending;
+};
+
+#endif
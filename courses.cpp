@@ -0,0 +1,193 @@
+#include "courses.hpp"
+
+bool load_roster_snapshot(const std::string &roster_file, SharedRoster &roster) {
+    auto snapshot = std::make_shared<RosterSnapshot>();
+    if (!import_rosters_v2(roster_file, snapshot->rosters, snapshot->teams, snapshot->runners)) {
+        return false;
+    }
+    roster = std::move(snapshot);
+    return true;
+}
+
+template <typename Rules>
+CourseRace<Rules>::CourseRace(const std::string &name, SharedRoster roster)
+: name(name)
+, gun(std::chrono::steady_clock::now())
+, running(false)
+, roster(std::move(roster))
+, dirty(false)
+, standings(std::make_shared<Standings>())
+{}
+
+template <typename Rules>
+CourseRace<Rules>::~CourseRace() {
+    stop();
+}
+
+template <typename Rules>
+void CourseRace<Rules>::start() {
+    stop();
+    gun = std::chrono::steady_clock::now();
+    running = true;
+    thread = std::thread(&CourseRace::run, this);
+}
+
+template <typename Rules>
+void CourseRace<Rules>::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    changed.notify_one();
+    scored.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+template <typename Rules>
+float CourseRace<Rules>::clock() const {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - gun).count();
+}
+
+template <typename Rules>
+void CourseRace<Rules>::add_time(float seconds) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        times.push_back(seconds);
+        dirty = true;
+    }
+    changed.notify_one();
+}
+
+template <typename Rules>
+void CourseRace<Rules>::add_barcode(RunnerId runner_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        barcodes.push_back(runner_id);
+        dirty = true;
+    }
+    changed.notify_one();
+}
+
+template <typename Rules>
+void CourseRace<Rules>::add_times(const std::vector<float> &more) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        times.insert(times.end(), more.begin(), more.end());
+        dirty = true;
+    }
+    changed.notify_one();
+}
+
+template <typename Rules>
+void CourseRace<Rules>::add_barcodes(const std::vector<RunnerId> &more) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        barcodes.insert(barcodes.end(), more.begin(), more.end());
+        dirty = true;
+    }
+    changed.notify_one();
+}
+
+template <typename Rules>
+void CourseRace<Rules>::set_roster(SharedRoster roster, bool rescore) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->roster = std::move(roster);
+        dirty = dirty || rescore;
+    }
+    changed.notify_one();
+}
+
+template <typename Rules>
+std::shared_ptr<const Standings> CourseRace<Rules>::get_standings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return standings;
+}
+
+template <typename Rules>
+std::shared_ptr<const Standings> CourseRace<Rules>::wait_standings(std::uint64_t generation) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    scored.wait(lock, [&] () { return standings->generation > generation || !running; });
+    return standings;
+}
+
+template <typename Rules>
+const std::string &CourseRace<Rules>::get_name() const {
+    return name;
+}
+
+template <typename Rules>
+std::vector<RunnerId> CourseRace<Rules>::get_barcodes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return barcodes;
+}
+
+template <typename Rules>
+void CourseRace<Rules>::run() {
+    std::uint64_t generation = 0;
+    Finishes all;
+    for (;;) {
+        auto next = std::make_shared<Standings>();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] () { return dirty || !running; });
+            if (!running) {
+                return;
+            }
+            dirty = false;
+            next->roster = roster;
+            next->times = times.size();
+            next->barcodes = barcodes.size();
+            make_finishes(times, barcodes, all);
+        }
+
+        // scored outside the lock, so the timer and scanner never wait on it
+        const auto &snapshot = *next->roster;
+        next->finishes.reserve(all.size());
+        for (auto &finish : all) {
+            if (snapshot.rosters.runner_to_team.count(finish.runner_id)) {
+                next->finishes.push_back(finish);
+            }
+        }
+        score_race<Rules>(snapshot.runners, snapshot.teams, snapshot.rosters, next->finishes, next->results);
+        next->generation = ++generation;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            standings = std::move(next);
+        }
+        scored.notify_all();
+    }
+}
+
+template <typename Rules>
+bool reload_courses(const std::string &roster_file, SharedRoster &roster,
+        std::vector<std::unique_ptr<CourseRace<Rules>>> &races, RosterDiff &diff) {
+
+    auto next = std::make_shared<RosterSnapshot>(*roster);
+    if (!reload_roster(roster_file, next->rosters, next->teams, next->runners, diff)) {
+        return false;
+    }
+    if (empty(diff)) {
+        return true;
+    }
+    roster = std::move(next);
+    for (auto &race : races) {
+        race->set_roster(roster, rescores(diff, race->get_barcodes()));
+    }
+    return true;
+}
+
+template class CourseRace<Nfhs>;
+template class CourseRace<FourScorer>;
+template class CourseRace<SixDisplacer>;
+
+#define INSTANTIATE_RELOAD(Rules) \
+    template bool reload_courses<Rules>(const std::string &roster_file, SharedRoster &roster, \
+        std::vector<std::unique_ptr<CourseRace<Rules>>> &races, RosterDiff &diff);
+
+INSTANTIATE_RELOAD(Nfhs)
+INSTANTIATE_RELOAD(FourScorer)
+INSTANTIATE_RELOAD(SixDisplacer)
@@ -0,0 +1,102 @@
+#ifndef COURSES_HPP
+#define COURSES_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "reload.hpp"
+#include "wildcat.hpp"
+
+// The meet's roster, loaded once and never changed afterwards, so every
+// race on the day can read it from its own thread without locking. A new
+// roster is a new snapshot; races still holding the old one keep it alive.
+struct RosterSnapshot {
+    Runners runners;
+    Rosters rosters;
+    Teams teams;
+};
+
+using SharedRoster = std::shared_ptr<const RosterSnapshot>;
+
+bool load_roster_snapshot(const std::string &roster_file, SharedRoster &roster);
+
+// A course's standings as of one scoring pass. Replaced, never changed,
+// so a reader can keep one as long as it likes.
+struct Standings {
+    SharedRoster roster;
+    Finishes finishes;
+    Results results;
+    std::size_t times = 0;    // how many of the course's times and
+    std::size_t barcodes = 0; // barcodes went into this pass
+    std::uint64_t generation = 0;
+};
+
+// One race running on its own course: its own clock, its own times and
+// barcodes, and its own scoring thread. Times and barcodes may come from
+// any thread; each batch of them wakes the scorer, which rescores against
+// the course's roster snapshot and publishes fresh standings. Barcodes
+// not on the roster are left out of the scoring.
+template <typename Rules = Nfhs>
+class CourseRace {
+public:
+    CourseRace(const std::string &name, SharedRoster roster);
+    ~CourseRace();
+    CourseRace(const CourseRace &) = delete;
+    CourseRace &operator=(const CourseRace &) = delete;
+
+    // fires the gun and starts the scorer
+    void start();
+    void stop();
+
+    // seconds since this course's gun
+    float clock() const;
+
+    void add_time(float seconds);
+    void add_barcode(RunnerId runner_id);
+    // a file's worth at once, scored as one batch
+    void add_times(const std::vector<float> &more);
+    void add_barcodes(const std::vector<RunnerId> &more);
+    // Everything so far is rescored against the new roster, unless the
+    // caller knows none of this course's finishers changed; then it's
+    // only picked up by the next scoring pass.
+    void set_roster(SharedRoster roster, bool rescore = true);
+
+    // never null; empty before the first scoring pass
+    std::shared_ptr<const Standings> get_standings() const;
+    // blocks until standings newer than `generation` are out, or stop()
+    std::shared_ptr<const Standings> wait_standings(std::uint64_t generation) const;
+    const std::string &get_name() const;
+    std::vector<RunnerId> get_barcodes() const;
+
+private:
+    void run();
+
+    std::string name;
+    std::chrono::steady_clock::time_point gun;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    mutable std::condition_variable scored;
+    SharedRoster roster;
+    std::vector<float> times;
+    std::vector<RunnerId> barcodes;
+    bool dirty;
+    std::shared_ptr<const Standings> standings;
+};
+
+// Reloads roster_file over a copy of `roster` (snapshots never change)
+// and hands the copy to every race. Only the races whose finishers the
+// diff touches are rescored.
+template <typename Rules>
+bool reload_courses(const std::string &roster_file, SharedRoster &roster,
+    std::vector<std::unique_ptr<CourseRace<Rules>>> &races, RosterDiff &diff);
+
+#endif
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include "duals.hpp"
+
+// A team's displacers are all that can matter in a dual: they score,
+// push back the other team and break ties.
+template <typename Rules>
+struct Lineup {
+    unsigned int count = 0;
+    Place places[Rules::displacers];
+    Time time;
+};
+
+const Dual &DualMatrix::at(std::size_t row, std::size_t column) const {
+    return duals[row * team_ids.size() + column];
+}
+
+template <typename Rules>
+static void fill_squad(Squad &squad, const Lineup<Rules> &lineup) {
+    squad.score = 0;
+    squad.time = lineup.count >= Rules::minimum_squad ? lineup.time : Time(0);
+    squad.places.clear();
+}
+
+template <typename Rules>
+static void score_dual(const Lineup<Rules> &a, const Lineup<Rules> &b, Squad &squad_a, Squad &squad_b) {
+    fill_squad(squad_a, a);
+    fill_squad(squad_b, b);
+
+    // incomplete teams neither score nor displace
+    const unsigned int a_count = a.count >= Rules::minimum_squad ? std::min(a.count, Rules::displacers) : 0;
+    const unsigned int b_count = b.count >= Rules::minimum_squad ? std::min(b.count, Rules::displacers) : 0;
+
+    unsigned int i = 0;
+    unsigned int j = 0;
+    unsigned int place_number = 1;
+    while (i < a_count || j < b_count) {
+        if (j == b_count || (i < a_count && a.places[i].place_number < b.places[j].place_number)) {
+            squad_a.places.push_back({ a.places[i].runner_id, place_number });
+            if (i < Rules::scorers) {
+                squad_a.score += place_number;
+            }
+            i++;
+        } else {
+            squad_b.places.push_back({ b.places[j].runner_id, place_number });
+            if (j < Rules::scorers) {
+                squad_b.score += place_number;
+            }
+            j++;
+        }
+        place_number++;
+    }
+}
+
+template <typename Rules>
+void score_duals(const Rosters &rosters, const Teams &teams, const Finishes &finishes, DualMatrix &matrix) {
+
+    matrix.team_ids.clear();
+    matrix.duals.clear();
+
+    std::map<TeamId, std::size_t> index;
+    for (auto &team : teams) {
+        index[team.first] = matrix.team_ids.size();
+        matrix.team_ids.push_back(team.first);
+    }
+    const auto n = matrix.team_ids.size();
+
+    std::vector<Lineup<Rules>> lineups(n);
+    for (unsigned int i = 0; i < finishes.size(); i++) {
+        const auto &finish = finishes[i];
+        // an unknown barcode or a team left out of `teams` has no lineup
+        auto team = rosters.runner_to_team.find(finish.runner_id);
+        if (team == rosters.runner_to_team.end()) {
+            continue;
+        }
+        auto row = index.find(team->second);
+        if (row == index.end()) {
+            continue;
+        }
+        auto &lineup = lineups[row->second];
+        if (lineup.count < Rules::displacers) {
+            lineup.places[lineup.count] = { finish.runner_id, i + 1 };
+        }
+        if (lineup.count < Rules::scorers) {
+            lineup.time = lineup.time + finish.time;
+        }
+        lineup.count++;
+    }
+
+    matrix.duals.resize(n * n, { Outcome::Tie, 0, 0 });
+
+    const auto workers = std::max(1u, std::thread::hardware_concurrency());
+    auto work = [&] (unsigned int worker) {
+        Squad a;
+        Squad b;
+        for (auto row = static_cast<std::size_t>(worker); row < n; row += workers) {
+            for (auto column = row + 1; column < n; column++) {
+                score_dual<Rules>(lineups[row], lineups[column], a, b);
+                const auto outcome = beats<Rules>(a, b) ? Outcome::Win : beats<Rules>(b, a) ? Outcome::Loss : Outcome::Tie;
+                matrix.duals[row * n + column] = { outcome, a.score, b.score };
+                matrix.duals[column * n + row] = {
+                    outcome == Outcome::Win ? Outcome::Loss : outcome == Outcome::Loss ? Outcome::Win : Outcome::Tie,
+                    b.score,
+                    a.score,
+                };
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int worker = 1; worker < workers; worker++) {
+        threads.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void output_duals(std::ostream &os, const Teams &teams, const DualMatrix &matrix) {
+    const auto n = matrix.team_ids.size();
+
+    std::stringstream ss;
+    auto extend = [&] (std::size_t limit) {
+        for (auto j = ss.str().length(); j < limit; j++) {
+            ss << ' ';
+        }
+    };
+    auto initials = [&] (TeamId team_id) -> const std::string & {
+        static const std::string none;
+        auto team = teams.find(team_id);
+        return team == teams.end() ? none : team->second.initials;
+    };
+
+    os << "DUAL MEETS\n";
+    os << "==================================================================================\n";
+    os << '\n';
+    ss << "Team";
+    extend(10);
+    ss << "W-L-T";
+    for (std::size_t column = 0; column < n; column++) {
+        extend(19 + 10 * column);
+        ss << initials(matrix.team_ids[column]);
+    }
+    os << ss.str() << '\n';
+    os << "----------------------------------------------------------------------------------\n";
+
+    for (std::size_t row = 0; row < n; row++) {
+        unsigned int record[3] = { 0, 0, 0 };
+        for (std::size_t column = 0; column < n; column++) {
+            if (column != row) {
+                record[static_cast<int>(matrix.at(row, column).outcome)]++;
+            }
+        }
+        ss.str("");
+        ss << initials(matrix.team_ids[row]);
+        extend(10);
+        ss << record[0] << '-' << record[1] << '-' << record[2];
+        for (std::size_t column = 0; column < n; column++) {
+            extend(19 + 10 * column);
+            if (column == row) {
+                ss << '-';
+                continue;
+            }
+            const auto &dual = matrix.at(row, column);
+            ss << (dual.outcome == Outcome::Win ? 'W' : dual.outcome == Outcome::Loss ? 'L' : 'T') << ' '
+                << dual.score << '-' << dual.opponent_score;
+        }
+        os << ss.str() << '\n';
+    }
+
+    os << "==================================================================================\n";
+}
+
+template void score_duals<Nfhs>(const Rosters &rosters, const Teams &teams, const Finishes &finishes, DualMatrix &matrix);
+template void score_duals<FourScorer>(const Rosters &rosters, const Teams &teams, const Finishes &finishes, DualMatrix &matrix);
+template void score_duals<SixDisplacer>(const Rosters &rosters, const Teams &teams, const Finishes &finishes, DualMatrix &matrix);
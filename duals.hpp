@@ -0,0 +1,37 @@
+#ifndef DUALS_HPP
+#define DUALS_HPP
+
+#include <ostream>
+#include <vector>
+#include "wildcat.hpp"
+
+enum class Outcome {
+    Win,
+    Loss,
+    Tie,
+};
+
+// One team's side of a virtual dual meet against another team.
+struct Dual {
+    Outcome outcome;
+    unsigned int score;
+    unsigned int opponent_score;
+};
+
+// Head-to-head scores of every pair of teams from one race. Row i holds
+// team_ids[i]'s result against each column's team; the diagonal is a tie.
+struct DualMatrix {
+    std::vector<TeamId> team_ids;
+    std::vector<Dual> duals;
+
+    const Dual &at(std::size_t row, std::size_t column) const;
+};
+
+template <typename Rules = Nfhs>
+void score_duals(const Rosters &rosters, const Teams &teams, const Finishes &finishes, DualMatrix &matrix);
+
+// The matrix as a table: each team's dual record, then its result and
+// score against every other team, read across.
+void output_duals(std::ostream &os, const Teams &teams, const DualMatrix &matrix);
+
+#endif
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "feed.hpp"
+
+static const char feed_magic[4] = { 'W', 'C', 'F', 'D' };
+static const std::uint32_t feed_version = 1;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+    "the feed's atomics must be lock-free to work across processes");
+
+struct FeedHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t max_finishes;
+    std::uint32_t max_results;
+    std::uint64_t slot_bytes;
+    std::atomic<std::uint32_t> current;
+    std::atomic<std::uint64_t> generation;
+};
+
+// followed by max_finishes FeedFinish and max_results FeedResult
+struct FeedSlot {
+    std::atomic<std::uint32_t> sequence; // odd while being written
+    std::uint32_t finish_count;
+    std::uint32_t result_count;
+    std::uint64_t generation;
+};
+
+static std::size_t round_up(std::size_t bytes) {
+    return (bytes + 63) / 64 * 64;
+}
+
+static std::size_t slot_offset(std::uint32_t slot, std::uint64_t slot_bytes) {
+    return round_up(sizeof(FeedHeader)) + slot * slot_bytes;
+}
+
+static void copy_string(char *to, std::size_t size, const std::string &from) {
+    const auto n = std::min(size - 1, from.size());
+    std::memcpy(to, from.data(), n);
+    std::memset(to + n, 0, size - n);
+}
+
+FeedPublisher::FeedPublisher()
+: data(nullptr)
+, length(0)
+{
+}
+
+FeedPublisher::~FeedPublisher() {
+    close();
+}
+
+bool FeedPublisher::open(const std::string &name, std::uint32_t max_finishes, std::uint32_t max_results) {
+    close();
+
+    const auto slot_bytes = round_up(sizeof(FeedSlot)) +
+        round_up(max_finishes * sizeof(FeedFinish)) + round_up(max_results * sizeof(FeedResult));
+    const auto bytes = slot_offset(2, slot_bytes);
+
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "FeedPublisher::open(): Can't open \"" << name << "\"\n";
+        return false;
+    }
+    if (ftruncate(fd, bytes) != 0) {
+        std::cerr << "FeedPublisher::open(): Can't size \"" << name << "\"\n";
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "FeedPublisher::open(): Can't map \"" << name << "\"\n";
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    this->name = name;
+    data = static_cast<unsigned char *>(mapped);
+    length = bytes;
+
+    auto *header = reinterpret_cast<FeedHeader *>(data);
+    header->version = feed_version;
+    header->max_finishes = max_finishes;
+    header->max_results = max_results;
+    header->slot_bytes = slot_bytes;
+    header->current.store(0, std::memory_order_relaxed);
+    header->generation.store(0, std::memory_order_relaxed);
+    for (std::uint32_t i = 0; i < 2; i++) {
+        auto *slot = reinterpret_cast<FeedSlot *>(data + slot_offset(i, slot_bytes));
+        slot->sequence.store(0, std::memory_order_relaxed);
+        slot->finish_count = 0;
+        slot->result_count = 0;
+        slot->generation = 0;
+    }
+    // readers check the magic last, so it goes in last
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, feed_magic, sizeof feed_magic);
+    return true;
+}
+
+void FeedPublisher::close() {
+    if (data) {
+        munmap(data, length);
+        shm_unlink(name.c_str());
+    }
+    data = nullptr;
+    length = 0;
+}
+
+void FeedPublisher::leave() {
+    if (data) {
+        munmap(data, length);
+    }
+    data = nullptr;
+    length = 0;
+}
+
+void FeedPublisher::publish(const Rosters &rosters, const Teams &teams, const Runners &runners,
+        const Finishes &finishes, const Results &results) {
+    if (!data) {
+        return;
+    }
+    auto *header = reinterpret_cast<FeedHeader *>(data);
+    const auto next = header->current.load(std::memory_order_relaxed) ^ 1;
+    auto *bytes = data + slot_offset(next, header->slot_bytes);
+    auto *slot = reinterpret_cast<FeedSlot *>(bytes);
+    auto *feed_finishes = reinterpret_cast<FeedFinish *>(bytes + round_up(sizeof(FeedSlot)));
+    auto *feed_results = reinterpret_cast<FeedResult *>(
+        bytes + round_up(sizeof(FeedSlot)) + round_up(header->max_finishes * sizeof(FeedFinish)));
+
+    const auto sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto generation = header->generation.load(std::memory_order_relaxed) + 1;
+    slot->generation = generation;
+    slot->finish_count = std::min<std::size_t>(finishes.size(), header->max_finishes);
+    for (std::uint32_t i = 0; i < slot->finish_count; i++) {
+        const auto &finish = finishes[i];
+        auto &out = feed_finishes[i];
+        out.runner_id = finish.runner_id;
+        out.seconds = finish.time.get_total_seconds();
+        out.score = finish.score;
+        auto team = rosters.runner_to_team.find(finish.runner_id);
+        out.team_id = team != rosters.runner_to_team.end() ? team->second : -1;
+        auto initials = team != rosters.runner_to_team.end() ? teams.find(team->second) : teams.end();
+        copy_string(out.initials, sizeof out.initials, initials != teams.end() ? initials->second.initials : "");
+        auto runner = runners.find(finish.runner_id);
+        copy_string(out.name, sizeof out.name, runner != runners.end() ? runner->second.name : "");
+    }
+    slot->result_count = std::min<std::size_t>(results.size(), header->max_results);
+    for (std::uint32_t i = 0; i < slot->result_count; i++) {
+        const auto &result = results[i];
+        auto &out = feed_results[i];
+        out.place = result.place;
+        out.team_id = result.team_id;
+        out.score = result.squad.score;
+        out.seconds = result.squad.time.get_total_seconds();
+        out.place_count = std::min<std::size_t>(result.squad.places.size(), 8);
+        for (std::uint32_t j = 0; j < out.place_count; j++) {
+            out.places[j] = result.squad.places[j].place_number;
+        }
+        auto team = teams.find(result.team_id);
+        copy_string(out.initials, sizeof out.initials, team != teams.end() ? team->second.initials : "");
+    }
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    header->current.store(next, std::memory_order_release);
+    header->generation.store(generation, std::memory_order_release);
+}
+
+void FeedPublisher::publish(const Wildcat &w) {
+    switch (w.heat.tag) {
+    case Heat::Tag::Single:
+        publish(w.rosters, w.teams, w.runners, *w.heat.single.finishes, *w.heat.single.results);
+        break;
+    case Heat::Tag::Combined:
+        publish(w.rosters, w.teams, w.runners, *w.heat.combined.varsity_finishes, *w.heat.combined.varsity_results);
+        break;
+    }
+}
+
+FeedReader::FeedReader()
+: data(nullptr)
+, length(0)
+{
+}
+
+FeedReader::~FeedReader() {
+    close();
+}
+
+bool FeedReader::open(const std::string &name) {
+    close();
+
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "FeedReader::open(): No feed \"" << name << "\"\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FeedHeader)) {
+        std::cerr << "FeedReader::open() with \"" << name << "\": not a results feed\n";
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "FeedReader::open() with \"" << name << "\": can't map\n";
+        return false;
+    }
+    data = static_cast<const unsigned char *>(mapped);
+    length = st.st_size;
+
+    const auto *header = reinterpret_cast<const FeedHeader *>(data);
+    const bool ok = std::equal(feed_magic, feed_magic + sizeof feed_magic, header->magic);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!ok || header->version != feed_version || slot_offset(2, header->slot_bytes) > length) {
+        std::cerr << "FeedReader::open() with \"" << name << "\": not a results feed\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void FeedReader::close() {
+    if (data) {
+        munmap(const_cast<unsigned char *>(data), length);
+    }
+    data = nullptr;
+    length = 0;
+}
+
+std::uint64_t FeedReader::generation() const {
+    if (!data) {
+        return 0;
+    }
+    return reinterpret_cast<const FeedHeader *>(data)->generation.load(std::memory_order_acquire);
+}
+
+void FeedReader::view(FeedView &view) const {
+    const auto *header = reinterpret_cast<const FeedHeader *>(data);
+    for (;;) {
+        const auto current = header->current.load(std::memory_order_acquire);
+        const auto *bytes = data + slot_offset(current, header->slot_bytes);
+        const auto *slot = reinterpret_cast<const FeedSlot *>(bytes);
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            // the publisher lapped us onto the slot it is writing
+            continue;
+        }
+        view.generation = slot->generation;
+        view.finish_count = std::min(slot->finish_count, header->max_finishes);
+        view.result_count = std::min(slot->result_count, header->max_results);
+        view.finishes = reinterpret_cast<const FeedFinish *>(bytes + round_up(sizeof(FeedSlot)));
+        view.results = reinterpret_cast<const FeedResult *>(
+            bytes + round_up(sizeof(FeedSlot)) + round_up(header->max_finishes * sizeof(FeedFinish)));
+        view.slot = slot;
+        view.sequence = sequence;
+        return;
+    }
+}
+
+bool FeedReader::valid(const FeedView &view) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto *slot = static_cast<const FeedSlot *>(view.slot);
+    return slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
@@ -0,0 +1,104 @@
+#ifndef FEED_HPP
+#define FEED_HPP
+
+#include <cstdint>
+#include <string>
+#include "wildcat.hpp"
+
+// Live standings in POSIX shared memory for scoreboards and announcer
+// displays running as separate processes. The region has two slots, each
+// guarded by a seqlock: the scorer writes the slot readers aren't pointed
+// at and then flips `current`, so it never waits on a reader, and a reader
+// only has to retry if the scorer publishes twice during one read.
+//
+// Strings are cut to fit and always nul terminated.
+struct FeedFinish {
+    std::int32_t runner_id;
+    std::int32_t team_id;
+    float seconds;
+    std::uint32_t score;
+    char initials[8];
+    char name[40];
+};
+
+struct FeedResult {
+    std::uint32_t place;
+    std::int32_t team_id;
+    std::uint32_t score;
+    float seconds;
+    std::uint32_t place_count;
+    std::uint32_t places[8]; // scorers then displacers
+    char initials[8];
+};
+
+// Points straight into the shared region; only trust what was read from
+// it once FeedReader::valid() says the slot wasn't overwritten meanwhile.
+struct FeedView {
+    std::uint64_t generation; // bumped on every publish
+    std::uint32_t finish_count;
+    std::uint32_t result_count;
+    const FeedFinish *finishes;
+    const FeedResult *results;
+    const void *slot;
+    std::uint32_t sequence;
+};
+
+class FeedPublisher {
+public:
+    FeedPublisher();
+    ~FeedPublisher();
+    FeedPublisher(const FeedPublisher &) = delete;
+    FeedPublisher &operator=(const FeedPublisher &) = delete;
+
+    // name as for shm_open(), e.g. "/wildcat"
+    bool open(const std::string &name, std::uint32_t max_finishes = 4096, std::uint32_t max_results = 512);
+    // unlinks the region; readers keep what they have mapped
+    void close();
+    // unmaps but leaves the region up, so a one-shot scorer's standings
+    // stay posted after it exits
+    void leave();
+
+    // Finishes and results past the region's capacity are dropped.
+    void publish(const Rosters &rosters, const Teams &teams, const Runners &runners,
+        const Finishes &finishes, const Results &results);
+    // a scored meet: its race, or the varsity race of a combined heat
+    void publish(const Wildcat &w);
+
+private:
+    std::string name;
+    unsigned char *data;
+    std::size_t length;
+};
+
+class FeedReader {
+public:
+    FeedReader();
+    ~FeedReader();
+    FeedReader(const FeedReader &) = delete;
+    FeedReader &operator=(const FeedReader &) = delete;
+
+    bool open(const std::string &name);
+    void close();
+
+    // bumped on every publish, 0 before the first
+    std::uint64_t generation() const;
+
+    void view(FeedView &view) const;
+    bool valid(const FeedView &view) const;
+
+    // Calls on_view with a consistent view, retrying while torn.
+    template <typename F>
+    void read(F on_view) const {
+        FeedView v;
+        do {
+            view(v);
+            on_view(v);
+        } while (!valid(v));
+    }
+
+private:
+    const unsigned char *data;
+    std::size_t length;
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "follow.hpp"
+
+FileFollower::FileFollower()
+: fd(-1)
+, primed(false)
+{}
+
+FileFollower::~FileFollower() {
+    close();
+}
+
+bool FileFollower::open(const std::string &times_file, const std::string &barcode_file) {
+    close();
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "FileFollower::open(): Can't start inotify\n";
+        return false;
+    }
+    times = Tail();
+    times.path = times_file;
+    barcodes = Tail();
+    barcodes.path = barcode_file;
+    if (!watch(times) || !watch(barcodes)) {
+        close();
+        return false;
+    }
+    primed = false;
+    return true;
+}
+
+void FileFollower::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int FileFollower::get_fd() const {
+    return fd;
+}
+
+// The directory is watched rather than the file, so a file that doesn't
+// exist yet, or is replaced by a rename, is still noticed.
+bool FileFollower::watch(Tail &tail) {
+    const auto slash = tail.path.rfind('/');
+    const auto dir = slash == std::string::npos ? std::string(".") : tail.path.substr(0, slash + 1);
+    tail.name = slash == std::string::npos ? tail.path : tail.path.substr(slash + 1);
+    const auto mask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO;
+    if (inotify_add_watch(fd, dir.c_str(), mask) < 0) {
+        std::cerr << "FileFollower::open(): Can't watch \"" << dir << "\"\n";
+        return false;
+    }
+    return true;
+}
+
+bool FileFollower::read_tail(Tail &tail, std::string &chunk) {
+    chunk.clear();
+
+    const int file = ::open(tail.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        // not written yet
+        return errno == ENOENT;
+    }
+    struct stat st;
+    if (fstat(file, &st) != 0) {
+        ::close(file);
+        return false;
+    }
+    if ((tail.inode && st.st_ino != tail.inode) || st.st_size < tail.offset) {
+        tail.offset = 0;
+        tail.line = 1;
+        tail.restarted = true;
+    }
+    tail.inode = st.st_ino;
+
+    chunk.resize(st.st_size - tail.offset);
+    std::size_t done = 0;
+    while (done < chunk.size()) {
+        const auto got = pread(file, &chunk[done], chunk.size() - done, tail.offset + done);
+        if (got <= 0) {
+            break;
+        }
+        done += got;
+    }
+    ::close(file);
+
+    // only whole lines; the rest is still being written
+    const auto last = chunk.rfind('\n', done ? done - 1 : 0);
+    chunk.resize(done && last != std::string::npos ? last + 1 : 0);
+    return true;
+}
+
+bool FileFollower::poll(int timeout_ms, FollowUpdate &update) {
+    update.times.clear();
+    update.barcodes.clear();
+    update.times_restarted = false;
+    update.barcodes_restarted = false;
+
+    if (primed) {
+        pollfd p = { fd, POLLIN, 0 };
+        if (::poll(&p, 1, timeout_ms) <= 0 && !times.changed && !barcodes.changed) {
+            return true;
+        }
+        alignas(inotify_event) char events[4096];
+        for (;;) {
+            const auto got = read(fd, events, sizeof events);
+            if (got <= 0) {
+                break;
+            }
+            for (ssize_t i = 0; i < got; ) {
+                const auto *event = reinterpret_cast<const inotify_event *>(events + i);
+                if (event->len) {
+                    times.changed = times.changed || times.name == event->name;
+                    barcodes.changed = barcodes.changed || barcodes.name == event->name;
+                }
+                i += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+    primed = true;
+
+    // a file stays changed until its new lines parse
+    std::string chunk;
+    bool ok = true;
+    if (times.changed) {
+        if (read_tail(times, chunk) && append_times_v2(chunk, times.path, times.line, update.times)) {
+            times.offset += chunk.size();
+            times.line += std::count(chunk.begin(), chunk.end(), '\n');
+            update.times_restarted = times.restarted;
+            times.restarted = false;
+            times.changed = false;
+        } else {
+            update.times.clear();
+            ok = false;
+        }
+    }
+    if (barcodes.changed) {
+        if (read_tail(barcodes, chunk) && append_barcodes_v2(chunk, barcodes.path, barcodes.line, update.barcodes)) {
+            barcodes.offset += chunk.size();
+            barcodes.line += std::count(chunk.begin(), chunk.end(), '\n');
+            update.barcodes_restarted = barcodes.restarted;
+            barcodes.restarted = false;
+            barcodes.changed = false;
+        } else {
+            update.barcodes.clear();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+ChuteFollower::ChuteFollower(float lag)
+: lag(lag)
+, started(false)
+, newest(0)
+{}
+
+bool ChuteFollower::open(const std::vector<std::string> &dirs) {
+    followers.clear();
+    for (auto &dir : dirs) {
+        followers.emplace_back(new FileFollower());
+        if (!followers.back()->open(dir + "/times.txt", dir + "/barcodes.txt")) {
+            followers.clear();
+            return false;
+        }
+    }
+    lines.assign(dirs.size(), Lines());
+    merger.reset(new ChuteMerger(dirs.size()));
+    started = false;
+    newest = 0;
+    return true;
+}
+
+bool ChuteFollower::poll(int timeout_ms, Finishes &finishes, bool &restarted) {
+    restarted = false;
+
+    std::vector<pollfd> fds;
+    for (auto &follower : followers) {
+        fds.push_back({ follower->get_fd(), POLLIN, 0 });
+    }
+    ::poll(fds.data(), fds.size(), timeout_ms);
+
+    bool ok = true;
+    FollowUpdate update;
+    for (std::size_t i = 0; i < followers.size(); i++) {
+        ok = followers[i]->poll(0, update) && ok;
+        auto &l = lines[i];
+        if (update.times_restarted) {
+            l.times.clear();
+            restarted = true;
+        }
+        if (update.barcodes_restarted) {
+            l.barcodes.clear();
+            restarted = true;
+        }
+        l.times.insert(l.times.end(), update.times.begin(), update.times.end());
+        l.barcodes.insert(l.barcodes.end(), update.barcodes.begin(), update.barcodes.end());
+        for (auto seconds : update.times) {
+            if (!started || seconds > newest) {
+                started = true;
+                newest = seconds;
+                newest_at = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    // a replaced file can't be taken back out of the merge; start over
+    if (restarted) {
+        merger.reset(new ChuteMerger(followers.size()));
+        for (auto &l : lines) {
+            l.pushed_times = 0;
+            l.pushed_barcodes = 0;
+        }
+        finishes.clear();
+    }
+
+    // merging drains the chutes' queues, so a full one is pushed again
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        auto &l = lines[i];
+        auto &chute = merger->chute(i);
+        for (; l.pushed_times < l.times.size(); l.pushed_times++) {
+            while (!chute.push_time(l.times[l.pushed_times])) {
+                merger->merge(finishes);
+            }
+        }
+        for (; l.pushed_barcodes < l.barcodes.size(); l.pushed_barcodes++) {
+            while (!chute.push_barcode(l.barcodes[l.pushed_barcodes])) {
+                merger->merge(finishes);
+            }
+        }
+    }
+
+    if (started) {
+        const std::chrono::duration<float> since = std::chrono::steady_clock::now() - newest_at;
+        for (std::size_t i = 0; i < lines.size(); i++) {
+            merger->chute(i).tick(newest + since.count() - lag);
+        }
+    }
+    merger->merge(finishes);
+    return ok;
+}
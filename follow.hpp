@@ -0,0 +1,102 @@
+#ifndef FOLLOW_HPP
+#define FOLLOW_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "chutes.hpp"
+#include "wildcat.hpp"
+
+// What turned up in the followed files since the last poll. A file that
+// shrank or was replaced is read again from the start; its `restarted`
+// is set and its vector holds the whole file, not just the new part.
+struct FollowUpdate {
+    std::vector<float> times;
+    std::vector<RunnerId> barcodes;
+    bool times_restarted = false;
+    bool barcodes_restarted = false;
+};
+
+// Follows times.txt and barcodes.txt while the timer and the scanner
+// append to them. inotify says when either changes; each file is read
+// from where the last complete line ended, so a poll costs the new bytes,
+// not the whole file. A line still being written is left for next time.
+class FileFollower {
+public:
+    FileFollower();
+    ~FileFollower();
+    FileFollower(const FileFollower &) = delete;
+    FileFollower &operator=(const FileFollower &) = delete;
+
+    // The files needn't exist yet. The first poll() reads what they hold.
+    bool open(const std::string &times_file, const std::string &barcode_file);
+    void close();
+
+    // Waits up to timeout_ms (-1 forever) for a change, then reads what was
+    // appended. False on a malformed line: none of that file's new lines
+    // are consumed, so the next poll tries them again, but whatever the
+    // other file had is still in `update`.
+    bool poll(int timeout_ms, FollowUpdate &update);
+
+    // readable when poll() has something, for a GUI's main loop
+    int get_fd() const;
+
+private:
+    struct Tail {
+        std::string path;
+        std::string name; // within the watched directory
+        ino_t inode = 0;
+        off_t offset = 0; // just past the last complete line
+        unsigned int line = 1;
+        bool restarted = false; // until the new start is consumed
+        bool changed = true;    // since its lines were last consumed
+    };
+
+    bool watch(Tail &tail);
+    // reads any complete lines past the tail's offset into `chunk`
+    bool read_tail(Tail &tail, std::string &chunk);
+
+    int fd;
+    Tail times;
+    Tail barcodes;
+    bool primed;
+};
+
+// Follows every finish chute's times.txt and barcodes.txt, one chute per
+// directory, and merges them through a ChuteMerger into one finish order.
+// A chute's timer is taken to write each time within `lag` seconds of the
+// crossing, so once any chute has written a time, every chute's clock
+// runs on from it, less the lag, and a quiet chute doesn't hold back the
+// rest.
+class ChuteFollower {
+public:
+    explicit ChuteFollower(float lag = 2);
+
+    bool open(const std::vector<std::string> &dirs);
+
+    // Waits up to timeout_ms (-1 forever) for a chute to change, then
+    // appends the finishes now known to come next. When a chute's file
+    // was replaced, `restarted` is set and `finishes` is filled again from
+    // the start. False on a malformed line, as FileFollower::poll().
+    bool poll(int timeout_ms, Finishes &finishes, bool &restarted);
+
+private:
+    struct Lines {
+        std::vector<float> times;
+        std::vector<RunnerId> barcodes;
+        std::size_t pushed_times = 0;
+        std::size_t pushed_barcodes = 0;
+    };
+
+    float lag;
+    std::vector<std::unique_ptr<FileFollower>> followers;
+    std::vector<Lines> lines;
+    std::unique_ptr<ChuteMerger> merger;
+    bool started;
+    float newest; // latest time any chute has written
+    std::chrono::steady_clock::time_point newest_at;
+};
+
+#endif
@@ -1,4 +1,28 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <map>
+#include <sys/stat.h>
+#include <thread>
+#include "archive.hpp"
+#include "athletes.hpp"
+#include "categories.hpp"
+#include "courses.hpp"
+#include "duals.hpp"
+#include "feed.hpp"
+#include "follow.hpp"
 #include "mainwindow.hpp"
+#include "parse.hpp"
+#include "projection.hpp"
+#include "report.hpp"
+#include "season.hpp"
+#include "simulate.hpp"
+#include "splits.hpp"
+#include "stations.hpp"
+#include "trace.hpp"
+#include "waves.hpp"
 
 /*
 int main(int argc, char **argv) {
@@ -37,22 +61,555 @@ int main(int argc, char **argv) {
 }
 */
 
-int main() {
+// wildcat --station <host> <port> <id> [clock offset ms] [loss 0-1]
+// Stands in for a remote timing station: every line on stdin is a time.
+static int run_station(int argc, char **argv) {
+    int port;
+    int id;
+    int offset_ms = 0;
+    float loss = 0;
+    if (argc < 5 ||
+        !parse_int(argv[3], argv[3] + std::strlen(argv[3]), port) ||
+        !parse_int(argv[4], argv[4] + std::strlen(argv[4]), id) ||
+        (argc >= 6 && !parse_int(argv[5], argv[5] + std::strlen(argv[5]), offset_ms)) ||
+        (argc >= 7 && !parse_seconds(argv[6], argv[6] + std::strlen(argv[6]), loss))) {
+        std::cerr << "usage: wildcat --station <host> <port> <id> [clock offset ms] [loss 0-1]\n";
+        return EXIT_FAILURE;
+    }
+
+    TimingStation station(id, offset_ms * 1000LL, loss);
+    if (!station.connect(argv[2], port))
+        return EXIT_FAILURE;
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        station.record();
+    }
+    // give NACKed retransmits a moment before hanging up
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    return EXIT_SUCCESS;
+}
+
+// The gun as a wall clock time today, "HH:MM:SS[.s]", on the monotonic
+// clock the receiver times with.
+static bool parse_gun(const std::string &text, std::uint64_t &gun_us) {
+    const auto first = text.find(':');
+    const auto second = first == std::string::npos ? first : text.find(':', first + 1);
+    int hours;
+    int minutes;
+    float seconds;
+    if (second == std::string::npos ||
+        !parse_int(text.data(), text.data() + first, hours) ||
+        !parse_int(text.data() + first + 1, text.data() + second, minutes) ||
+        !parse_seconds(text.data() + second + 1, text.data() + text.size(), seconds))
+        return false;
+
+    const auto now = std::chrono::system_clock::now();
+    const auto now_us = monotonic_us();
+    auto today = std::chrono::system_clock::to_time_t(now);
+    std::tm clock;
+    localtime_r(&today, &clock);
+    clock.tm_hour = hours;
+    clock.tm_min = minutes;
+    clock.tm_sec = 0;
+    const auto gun = std::chrono::system_clock::from_time_t(std::mktime(&clock)) +
+        std::chrono::microseconds(static_cast<long long>(seconds * 1000000));
+    const auto since = std::chrono::duration_cast<std::chrono::microseconds>(now - gun).count();
+    // before this machine booted can't be on its monotonic clock
+    if (since > static_cast<long long>(now_us))
+        return false;
+    gun_us = now_us - since;
+    return true;
+}
+
+// wildcat --receive <port> [times file] [gun HH:MM:SS[.s]]
+// The other end of --station: collects every station's times on the race
+// clock and appends them to the times file (times.txt by default) in the
+// timer's layout, station id in the second column, numbered on from the
+// lines already there, where --follow or a later scoring run picks them
+// up. The race clock starts at the gun time given, or else when Enter is
+// pressed at the gun. Each station's clock offset is reported once it's
+// known.
+static int run_receive(int argc, char **argv) {
+    int port;
+    std::uint64_t gun_us = 0;
+    if (argc < 3 || !parse_int(argv[2], argv[2] + std::strlen(argv[2]), port) ||
+        (argc >= 5 && !parse_gun(argv[4], gun_us))) {
+        std::cerr << "usage: wildcat --receive <port> [times file] [gun HH:MM:SS[.s]]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string times_file = argc >= 4 ? argv[3] : "times.txt";
+
+    // number on from what's already there, finishing a torn last line
+    std::string contents;
+    std::size_t received = 0;
+    if (read_file(times_file, contents))
+        received = std::count(contents.begin(), contents.end(), '\n');
+    std::ofstream file(times_file, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "\"" << times_file << "\" Can't open\n";
+        return EXIT_FAILURE;
+    }
+    if (!contents.empty() && contents.back() != '\n') {
+        file << '\n';
+        received++;
+    }
+
+    StationReceiver receiver;
+    if (!receiver.listen(port))
+        return EXIT_FAILURE;
+
+    std::vector<StationTime> times;
+    if (gun_us) {
+        receiver.set_gun(gun_us);
+    } else {
+        std::cout << "press Enter at the gun" << std::endl;
+        std::string line;
+        std::getline(std::cin, line);
+        // anything recorded before the gun isn't a finish
+        receiver.drain(times);
+        receiver.set_gun();
+        if (!times.empty())
+            std::cout << times.size() << " time(s) before the gun dropped\n";
+    }
+    std::cout << "gun" << std::endl;
+
+    std::map<std::uint8_t, long long> offsets;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        times.clear();
+        receiver.drain(times);
+        std::stable_sort(times.begin(), times.end(), [] (const StationTime &a, const StationTime &b) {
+            return a.seconds < b.seconds;
+        });
+        for (auto &time : times) {
+            // a station that synced late can still deliver one from before
+            if (time.seconds < 0)
+                continue;
+            file << ++received << '\t' << static_cast<int>(time.station) << "\t0\t00\t0\t0\t"
+                << std::fixed << std::setprecision(3) << time.seconds << '\n';
+            if (!offsets.count(time.station)) {
+                long long offset_us;
+                if (receiver.get_offset(time.station, offset_us)) {
+                    offsets[time.station] = offset_us;
+                    std::cout << "station " << static_cast<int>(time.station) << " clock offset "
+                        << offset_us / 1000.0 << " ms\n";
+                }
+            }
+        }
+        // whole lines only, so a follower never sees half of one
+        file.flush();
+        if (!times.empty())
+            std::cout << received << " time(s)" << std::endl;
+    }
+}
+
+// wildcat --scoreboard [feed name]
+// Follows a live results feed, as a scoreboard would. --follow and the
+// GUI publish /wildcat as finishes come in, a scoring run leaves its
+// final standings there, and wildcat-server publishes each meet as
+// /wildcat-<meet>.
+static int run_scoreboard(int argc, char **argv) {
+    FeedReader feed;
+    if (!feed.open(argc >= 3 ? argv[2] : "/wildcat"))
+        return EXIT_FAILURE;
+
+    std::uint64_t shown = 0;
+    std::stringstream ss;
+    for (;;) {
+        if (feed.generation() == shown) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            continue;
+        }
+        feed.read([&] (const FeedView &view) {
+            ss.str("");
+            ss << view.finish_count << " finished\n";
+            for (std::uint32_t i = 0; i < view.result_count; i++) {
+                const auto &result = view.results[i];
+                if (!result.score)
+                    continue;
+                ss << '#' << result.place << ' ' << result.initials << ' ' << result.score << '\n';
+            }
+            shown = view.generation;
+        });
+        std::cout << ss.str() << '\n';
+    }
+}
+
+// wildcat --courses [--watch] <course dir>...
+// Races run at the same time on different loops: roster.txt is loaded
+// once and shared, and each course directory's times.txt and barcodes.txt
+// are scored on that course's own thread. With --watch, late entries and
+// scratches keep coming: roster.txt is reloaded whenever it changes, and
+// each course it rescores is printed again.
+static int run_courses(int argc, char **argv) {
+    SharedRoster roster;
+    if (!load_roster_snapshot("roster.txt", roster))
+        return EXIT_FAILURE;
+
+    int first = 2;
+    const bool watch = argc > first && std::string(argv[first]) == "--watch";
+    if (watch)
+        first++;
+
+    std::vector<std::unique_ptr<CourseRace<>>> races;
+    std::vector<std::pair<std::size_t, std::size_t>> sizes;
+    for (int i = first; i < argc; i++) {
+        const std::string dir = argv[i];
+        std::vector<float> times;
+        std::vector<RunnerId> barcodes;
+        if (!import_times_v2(dir + "/times.txt", times) || !import_barcodes_v2(dir + "/barcodes.txt", barcodes))
+            return EXIT_FAILURE;
+
+        races.emplace_back(new CourseRace<>(dir, roster));
+        auto &race = *races.back();
+        race.start();
+        race.add_times(times);
+        race.add_barcodes(barcodes);
+        sizes.push_back({ times.size(), barcodes.size() });
+    }
+
+    std::vector<std::uint64_t> generations;
+    for (std::size_t i = 0; i < races.size(); i++) {
+        auto standings = races[i]->get_standings();
+        while (standings->times < sizes[i].first || standings->barcodes < sizes[i].second)
+            standings = races[i]->wait_standings(standings->generation);
+
+        std::cout << races[i]->get_name() << ":\n";
+        output_results(std::cout, standings->roster->rosters, standings->roster->teams, standings->roster->runners,
+            standings->finishes, standings->results);
+        generations.push_back(standings->generation);
+    }
+    if (!watch)
+        return EXIT_SUCCESS;
+
+    struct stat last;
+    if (stat("roster.txt", &last) != 0)
+        return EXIT_FAILURE;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        struct stat now;
+        if (stat("roster.txt", &now) != 0 || (now.st_mtim.tv_sec == last.st_mtim.tv_sec &&
+                now.st_mtim.tv_nsec == last.st_mtim.tv_nsec && now.st_size == last.st_size))
+            continue;
+        last = now;
+
+        // a file caught half-written fails to parse and is tried again
+        // when the write finishes
+        RosterDiff diff;
+        if (!reload_courses("roster.txt", roster, races, diff))
+            continue;
+        std::cout << "reload roster: " << diff << '\n';
+        for (std::size_t i = 0; i < races.size(); i++) {
+            if (!rescores(diff, races[i]->get_barcodes()))
+                continue;
+            auto standings = races[i]->wait_standings(generations[i]);
+            generations[i] = standings->generation;
+            std::cout << races[i]->get_name() << ":\n";
+            output_results(std::cout, standings->roster->rosters, standings->roster->teams, standings->roster->runners,
+                standings->finishes, standings->results);
+        }
+    }
+}
+
+// wildcat --splits <checkpoint dir>...
+// The race as it stood at each checkpoint, in course order: each
+// directory holds that checkpoint's times.txt and barcodes.txt, and the
+// finish can be the last of them.
+static int run_splits(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: wildcat --splits <checkpoint dir>...\n";
+        return EXIT_FAILURE;
+    }
+
+    Wildcat w;
+    if (!import_rosters_v2("roster.txt", w.rosters, w.teams, w.runners))
+        return EXIT_FAILURE;
+
+    const std::vector<std::string> dirs(argv + 2, argv + argc);
+    Splits splits;
+    make_splits(w.rosters, dirs, splits);
+    for (std::size_t checkpoint = 0; checkpoint < dirs.size(); checkpoint++) {
+        std::vector<float> times;
+        std::vector<RunnerId> barcodes;
+        Finishes finishes;
+        if (!import_times_v2(dirs[checkpoint] + "/times.txt", times) ||
+            !import_barcodes_v2(dirs[checkpoint] + "/barcodes.txt", barcodes))
+            return EXIT_FAILURE;
+        make_finishes(times, barcodes, finishes);
+        for (std::size_t i = 0; i < finishes.size(); i++) {
+            if (!record_split(splits, checkpoint, finishes[i].runner_id, finishes[i].time.get_total_seconds()))
+                std::cerr << dirs[checkpoint] << ": split #" << i + 1 << " runner \"" << finishes[i].runner_id
+                    << "\" is not on the roster\n";
+        }
+    }
+
+    for (std::size_t checkpoint = 0; checkpoint < dirs.size(); checkpoint++) {
+        output_splits(std::cout, w.runners, w.teams, w.rosters, splits, checkpoint);
+        std::cout << '\n';
+    }
+    return EXIT_SUCCESS;
+}
+
+// wildcat --archive <archive file> <meet dir>...
+// Scores each meet directory's roster.txt, times.txt and barcodes.txt as
+// a scoring run would and writes them all to one archive, each meet
+// labelled with its directory's name, for --season.
+static int run_archive(int argc, char **argv) {
+    if (argc < 4) {
+        std::cerr << "usage: wildcat --archive <archive file> <meet dir>...\n";
+        return EXIT_FAILURE;
+    }
+
+    ArchiveWriter writer;
+    for (int i = 3; i < argc; i++) {
+        std::string dir = argv[i];
+        while (dir.size() > 1 && dir.back() == '/')
+            dir.pop_back();
+        const auto slash = dir.rfind('/');
+        const auto label = slash == std::string::npos ? dir : dir.substr(slash + 1);
+
+        Wildcat w;
+        w.heat.set_combined();
+        if (!import_rosters_v2(dir + "/roster.txt", w.rosters, w.teams, w.runners) ||
+            !import_barcodes_v2(dir + "/barcodes.txt", w.barcodes) ||
+            !import_times_v2(dir + "/times.txt", w.times))
+            return EXIT_FAILURE;
+        make_finishes(w.times, w.barcodes, w.finishes);
+        if (!score(w) || !writer.add_meet(label, w))
+            return EXIT_FAILURE;
+    }
+    return writer.save(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// wildcat --season <archive file> [seed file] [top n]
+// The season so far from an archive of its meets: team averages and the
+// fastest girls and boys. With a seed file, everyone's season best is
+// written there too, ready for --simulate.
+static int run_season(int argc, char **argv) {
+    int n = 15;
+    if (argc < 3 || (argc >= 5 && (!parse_int(argv[4], argv[4] + std::strlen(argv[4]), n) || n <= 0))) {
+        std::cerr << "usage: wildcat --season <archive file> [seed file] [top n]\n";
+        return EXIT_FAILURE;
+    }
+
+    Archive archive;
+    Season season;
+    if (!load_archive(argv[2], archive) || !add_archive(season, archive))
+        return EXIT_FAILURE;
+    output_season(std::cout, season, n);
+
+    if (argc >= 4) {
+        std::ofstream file(argv[3]);
+        if (!file.is_open()) {
+            std::cerr << "Can't open \"" << argv[3] << "\"\n";
+            return EXIT_FAILURE;
+        }
+        std::vector<SeedTime> seeds;
+        seeds_from_season(season, seeds);
+        for (auto &seed : seeds)
+            file << seed.runner_id << '\t' << std::fixed << std::setprecision(2) << seed.mean << '\n';
+    }
+    return EXIT_SUCCESS;
+}
+
+// wildcat --simulate <seed file> <races> [random seed]
+// Each team's odds of winning and placing, from roster.txt and a seed
+// file: every simulated race draws each seeded runner's time around their
+// seed. A seed without its own deviation gets 2% of its time, about the
+// spread of one runner's races over a season.
+static int run_simulate(int argc, char **argv) {
+    int races;
+    int random_seed = 1;
+    if (argc < 4 ||
+        !parse_int(argv[3], argv[3] + std::strlen(argv[3]), races) || races <= 0 ||
+        (argc >= 5 && !parse_int(argv[4], argv[4] + std::strlen(argv[4]), random_seed))) {
+        std::cerr << "usage: wildcat --simulate <seed file> <races> [random seed]\n";
+        return EXIT_FAILURE;
+    }
+
+    Wildcat w;
+    std::vector<SeedTime> seeds;
+    if (!import_rosters_v2("roster.txt", w.rosters, w.teams, w.runners) || !import_seeds(argv[2], seeds))
+        return EXIT_FAILURE;
+    for (auto &seed : seeds) {
+        if (seed.deviation == 0)
+            seed.deviation = seed.mean * 0.02f;
+    }
+
+    Simulation simulation;
+    simulate(w.rosters, w.teams, seeds, races, random_seed, simulation);
+    output_simulation(std::cout, w.teams, simulation);
+    return EXIT_SUCCESS;
+}
+
+// wildcat --follow [chute dir]...
+// Scores the race as the timer and the scanner append to times.txt and
+// barcodes.txt: only the new lines are read and only the new finishes
+// are scored. A finish line with several chutes gives each chute's timer
+// and scanner a directory of their own; the chutes are merged into one
+// finish order before scoring.
+static int run_follow(int argc, char **argv) {
+    Wildcat w;
+    if (!import_rosters_v2("roster.txt", w.rosters, w.teams, w.runners))
+        return EXIT_FAILURE;
+
+    std::vector<std::string> dirs(argv + 2, argv + argc);
+    if (dirs.empty())
+        dirs.push_back(".");
+    ChuteFollower follower;
+    if (!follower.open(dirs))
+        return EXIT_FAILURE;
+
+    FeedPublisher feed;
+    if (!feed.open("/wildcat"))
+        std::cerr << "no results feed for scoreboards\n";
+
+    Projection projection;
+    start_projection(w.rosters, {}, projection);
+    std::size_t scored = 0;
+    bool restarted;
+    for (;;) {
+        // a bad line was reported; it's read again once the file changes.
+        // The timeout lets a quiet chute's clock move on.
+        follower.poll(500, w.finishes, restarted);
+
+        if (restarted) {
+            start_projection(w.rosters, {}, projection);
+            scored = 0;
+        }
+
+        if (w.finishes.size() == scored)
+            continue;
+        for (; scored < w.finishes.size(); scored++)
+            project_finish(w.finishes[scored].runner_id, w.finishes[scored].time.get_total_seconds(), projection);
+        feed.publish(w.rosters, w.teams, w.runners, projection.actual, projection.actual_results);
+
+        std::stringstream ss;
+        ss << scored << " finished\n";
+        for (auto &result : projection.actual_results) {
+            if (!result.squad.score)
+                continue;
+            ss << '#' << result.place << ' ' << w.teams[result.team_id].initials << ' ' << result.squad.score << '\n';
+        }
+        std::cout << ss.str() << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--follow")
+        return run_follow(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--courses")
+        return run_courses(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--station")
+        return run_station(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--receive")
+        return run_receive(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--scoreboard")
+        return run_scoreboard(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--simulate")
+        return run_simulate(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--splits")
+        return run_splits(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--archive")
+        return run_archive(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "--season")
+        return run_season(argc, argv);
+
+    // wildcat --build-db <roster file> <database file>
+    if (argc >= 4 && std::string(argv[1]) == "--build-db")
+        return build_athlete_db(argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+
     Wildcat w;
     w.heat.set_combined();
 
-    if (!import_rosters_v1("roster.txt", w.rosters, w.teams, w.runners))
+    // wildcat --db <database file> [entries file]: the roster comes from
+    // the athlete database, for every team entered (one team's initials a
+    // line) or with a runner scanned
+    AthleteDb db;
+    std::vector<std::string> entries;
+    const bool use_db = argc >= 3 && std::string(argv[1]) == "--db";
+    if (use_db) {
+        if (!db.open(argv[2]))
+            return EXIT_FAILURE;
+        if (argc >= 4) {
+            std::ifstream file(argv[3]);
+            if (!file.is_open()) {
+                std::cerr << "No file \"" << argv[3] << "\"\n";
+                return EXIT_FAILURE;
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (!line.empty())
+                    entries.push_back(line);
+            }
+        }
+    } else if (!import_rosters_v2("roster.txt", w.rosters, w.teams, w.runners)) {
         return EXIT_FAILURE;
+    }
 
-    if (!import_barcodes_v1("barcodes.txt", w.barcodes))
+    // wildcat --replay <trace file | synthetic> [speed, 0 = flat out]
+    if (argc >= 3 && std::string(argv[1]) == "--replay") {
+        std::vector<Event> events;
+        if (std::string(argv[2]) == "synthetic") {
+            synthesize_trace(w.rosters, 0.5f, 1, events);
+        } else if (!load_trace(argv[2], events)) {
+            return EXIT_FAILURE;
+        }
+        float speed = 0;
+        if (argc >= 4 && !parse_seconds(argv[3], argv[3] + std::strlen(argv[3]), speed)) {
+            std::cerr << "\"" << argv[3] << "\" Not a speed\n";
+            return EXIT_FAILURE;
+        }
+        ReplayStats stats;
+        replay(events, speed, w, stats);
+        std::cout << stats << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    if (!import_barcodes_v2("barcodes.txt", w.barcodes))
+        return EXIT_FAILURE;
+
+    if (use_db && !materialize_rosters(db, entries, w.barcodes, w.rosters, w.teams, w.runners))
         return EXIT_FAILURE;
 
-    if (!import_times_v1("times.txt", w.times))
+    if (!import_times_v2("times.txt", w.times))
         return EXIT_FAILURE;
 
     make_finishes(w.times, w.barcodes, w.finishes);
-    score(w);
 
+    // wave starts: score on net time
+    if (std::ifstream("waves.txt")) {
+        Waves waves;
+        NetTimes net_times;
+        if (!import_waves("waves.txt", w.teams, waves))
+            return EXIT_FAILURE;
+        assign_waves(waves, w.rosters, w.times, w.barcodes, net_times);
+        net_finishes(net_times, w.finishes);
+    }
+
+    if (!score(w))
+        return EXIT_FAILURE;
+
+    output_warnings(std::cerr, w);
+
+    // the final standings stay posted for scoreboards after this exits
+    FeedPublisher feed;
+    if (feed.open("/wildcat")) {
+        feed.publish(w);
+        feed.leave();
+    }
 
     switch (w.heat.tag) {
     case Heat::Tag::Single: {
@@ -81,7 +638,8 @@ int main() {
     }
 
 
-    std::cout << w;
+    ReportCache<> reports;
+    reports.output(std::cout, w);
 
     // exported results
     if (true) {
@@ -90,11 +648,45 @@ int main() {
         if (!file.is_open()) {
             std::cerr << "Can't open \"both_results.txt\"\n";
         } else {
-            file << w;
+            reports.output(file, w);
         }
         file.close();
     }
 
+    // category awards
+    if (true) {
+        std::ofstream file("awards.txt");
+        if (!file.is_open()) {
+            std::cerr << "Can't open \"awards.txt\"\n";
+        } else {
+            output_awards(file, w, 15);
+        }
+    }
+
+    // dual meets: every pair of teams head to head, race by race
+    if (true) {
+        std::ofstream file("duals.txt");
+        if (!file.is_open()) {
+            std::cerr << "Can't open \"duals.txt\"\n";
+        } else {
+            DualMatrix matrix;
+            switch (w.heat.tag) {
+            case Heat::Tag::Single:
+                score_duals(w.rosters, w.teams, *w.heat.single.finishes, matrix);
+                output_duals(file, w.teams, matrix);
+                break;
+            case Heat::Tag::Combined:
+                file << "Varsity:\n";
+                score_duals(w.rosters, w.teams, *w.heat.combined.varsity_finishes, matrix);
+                output_duals(file, w.teams, matrix);
+                file << "\nJV:\n";
+                score_duals(w.rosters, w.teams, *w.heat.combined.jv_finishes, matrix);
+                output_duals(file, w.teams, matrix);
+                break;
+            }
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -1,22 +1,35 @@
 #include "mainwindow.hpp"
 
 MainWindow::MainWindow(SDL_Joystick *js, Mix_Chunk *beep)
-: load_config_button("Load Config")
-, load_roster_button("Load Roster")
-, load_barcodes_button("Load Barcodes")
-, load_results_button("Load Results")
-, export_results_button("Export Results")
-, pretty_print_results_button("Pretty Print Results")
-, start_button("Start")
+: start_button("Start")
 , stop_button("Stop")
 , race_time_label("00:00.0")
 , race_list(RLC_COUNT)
 , results_list(RLC_COUNT)
+, search_list(SLC_COUNT)
 , stop_race_dialog(*this, "Stop the race timer?", false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_OK_CANCEL)
 , quit_dialog(*this, "Are you sure you want to quit?", false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_YES_NO)
 , js(js)
 , beep(beep)
+, running(false)
+, projected_finishes(0)
 {
+    // The last meet's roster loads while the window is built, so it's
+    // there by the time anyone looks for a runner.
+    preload.reset(new Preload);
+    preload->started = std::chrono::steady_clock::now();
+    preload_done.connect(sigc::mem_fun(*this, &MainWindow::on_preload_done));
+    preload_thread = std::thread([this] () {
+        auto &p = *preload;
+        p.roster_loaded = import_rosters_v2("roster.txt", p.rosters, p.teams, p.runners);
+        if (p.roster_loaded) {
+            build_search_index(p.runners, p.rosters, p.teams, p.search_index);
+        }
+        p.seeds_loaded = import_seeds("seeds.txt", p.seeds);
+        p.loaded = std::chrono::steady_clock::now();
+        preload_done.emit();
+    });
+
     set_border_width(10);
     add(main_divider);
 
@@ -27,67 +40,17 @@ MainWindow::MainWindow(SDL_Joystick *js, Mix_Chunk *beep)
         race_list.set_column_title(RLC_NAME, "Name");
         race_list.set_column_title(RLC_TIME, "Time");
         race_list.set_column_title(RLC_SCORE, "Score");
-
-        for (int i = 0; i < 100; i++) {
-            auto row = race_list.append();
-            race_list.set_text(row, RLC_PLACE, "_");
-            race_list.set_text(row, RLC_TEAM, "_");
-            race_list.set_text(row, RLC_NAME, "_");
-            race_list.set_text(row, RLC_TIME, "_");
-            race_list.set_text(row, RLC_SCORE, "_");
-        }
-
         race_page.add(race_list);
     }
 
-    // config page
-    {
-        load_config_button.set_border_width(5);
-        load_config_button.signal_clicked().connect(
-            sigc::mem_fun(*this, &MainWindow::on_load_config_button_clicked));
-        config_box.pack_start(load_config_button, Gtk::PACK_SHRINK);
-        
-        load_roster_button.set_border_width(5);
-        load_roster_button.signal_clicked().connect(
-            sigc::mem_fun(*this, &MainWindow::on_load_roster_button_clicked));
-        config_box.pack_start(load_roster_button, Gtk::PACK_SHRINK);
-
-        config_box.set_border_width(5);
-        config_page.add(config_box);
-    }
-
-    // results page
-    {
-        load_barcodes_button.set_border_width(5);
-        load_barcodes_button.signal_clicked().connect(
-            sigc::mem_fun(*this, &MainWindow::on_load_barcodes_button_clicked));
-        results_box.pack_start(load_barcodes_button, Gtk::PACK_SHRINK);
-
-        load_results_button.set_border_width(5);
-        load_results_button.signal_clicked().connect(
-            sigc::mem_fun(*this, &MainWindow::on_load_results_button_clicked));
-        results_box.pack_start(load_results_button, Gtk::PACK_SHRINK);
-        
-        export_results_button.set_border_width(5);
-        export_results_button.signal_clicked().connect(
-            sigc::mem_fun(*this, &MainWindow::on_export_results_button_clicked));
-        results_box.pack_start(export_results_button, Gtk::PACK_SHRINK);
-        
-        pretty_print_results_button.set_border_width(5);
-        pretty_print_results_button.signal_clicked().connect(
-            sigc::mem_fun(*this, &MainWindow::on_pretty_print_results_button_clicked));
-        results_box.pack_start(pretty_print_results_button, Gtk::PACK_SHRINK);
-
-        results_box.set_border_width(5);
-        results_page.add(results_box);
-    }
-
     // notebook
     {
         notebook.append_page(race_page, "Race");
-        notebook.append_page(config_page, "Config");
-        notebook.append_page(results_page, "Results");
+        notebook.append_page(config_tab, "Config");
+        notebook.append_page(results_tab, "Results");
+        notebook.append_page(awards_tab, "Awards");
         notebook.set_border_width(5);
+        notebook.signal_switch_page().connect(sigc::mem_fun(*this, &MainWindow::on_switch_page));
         main_divider.add1(notebook);
     }
    
@@ -126,16 +89,34 @@ MainWindow::MainWindow(SDL_Joystick *js, Mix_Chunk *beep)
         results_list.set_column_title(RLC_TIME, "Time");
         results_list.set_column_title(RLC_SCORE, "Score");
 
-        results_frame.set_label("Results");
+        results_frame.set_label("Projected (Actual) Results");
         results_frame.add(results_list);
 
         right_vbox.pack_start(race_time_frame, Gtk::PACK_SHRINK);
+        right_vbox.pack_start(search_frame, Gtk::PACK_SHRINK);
         right_vbox.pack_end(results_frame, Gtk::PACK_EXPAND_WIDGET);
         right_vbox.set_border_width(5);
         
         main_divider.pack2(right_vbox, true, true);
     }
 
+    // runner search
+    {
+        search_entry.signal_search_changed().connect(sigc::mem_fun(*this, &MainWindow::on_search_changed));
+
+        search_list.set_column_title(SLC_BIB, "Bib");
+        search_list.set_column_title(SLC_TEAM, "Team");
+        search_list.set_column_title(SLC_NAME, "Name");
+        search_window.add(search_list);
+        search_window.set_min_content_height(150);
+
+        search_vbox.pack_start(search_entry, Gtk::PACK_SHRINK);
+        search_vbox.pack_start(search_window, Gtk::PACK_EXPAND_WIDGET);
+
+        search_frame.set_label("Find Runner");
+        search_frame.add(search_vbox);
+    }
+
     // stop race dialog
     {
         stop_race_dialog.set_title("Alert!");
@@ -145,24 +126,237 @@ MainWindow::MainWindow(SDL_Joystick *js, Mix_Chunk *beep)
     results_frame.hide();
 
 
+    if (!feed.open("/wildcat")) {
+        std::cerr << "no results feed for scoreboards\n";
+    }
+
     // SDL2
+    if (js) {
+        buttons.resize(SDL_JoystickNumButtons(js), 0);
+        Glib::signal_timeout().connect(sigc::mem_fun(*this, &MainWindow::on_poll_joystick), 5);
+    }
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow() {
+    finish_preload(false);
+    recorder.save("session.trace");
+}
+
+void MainWindow::on_switch_page(Gtk::Widget *, guint page_number) {
+    switch (page_number) {
+    case 1:
+        if (config_page) {
+            break;
+        }
+        config_page.reset(new ConfigPage);
+        {
+            auto &page = *config_page;
+            page.load_config_button.set_border_width(5);
+            page.load_config_button.signal_clicked().connect(
+                sigc::mem_fun(*this, &MainWindow::on_load_config_button_clicked));
+            page.box.pack_start(page.load_config_button, Gtk::PACK_SHRINK);
+
+            page.load_roster_button.set_border_width(5);
+            page.load_roster_button.signal_clicked().connect(
+                sigc::mem_fun(*this, &MainWindow::on_load_roster_button_clicked));
+            page.box.pack_start(page.load_roster_button, Gtk::PACK_SHRINK);
+
+            page.box.set_border_width(5);
+            config_tab.pack_start(page.box, Gtk::PACK_SHRINK);
+            config_tab.show_all_children();
+        }
+        break;
+    case 2:
+        if (results_page) {
+            break;
+        }
+        results_page.reset(new ResultsPage);
+        {
+            auto &page = *results_page;
+            page.load_barcodes_button.set_border_width(5);
+            page.load_barcodes_button.signal_clicked().connect(
+                sigc::mem_fun(*this, &MainWindow::on_load_barcodes_button_clicked));
+            page.box.pack_start(page.load_barcodes_button, Gtk::PACK_SHRINK);
+
+            page.load_results_button.set_border_width(5);
+            page.load_results_button.signal_clicked().connect(
+                sigc::mem_fun(*this, &MainWindow::on_load_results_button_clicked));
+            page.box.pack_start(page.load_results_button, Gtk::PACK_SHRINK);
+
+            page.export_results_button.set_border_width(5);
+            page.export_results_button.signal_clicked().connect(
+                sigc::mem_fun(*this, &MainWindow::on_export_results_button_clicked));
+            page.box.pack_start(page.export_results_button, Gtk::PACK_SHRINK);
+
+            page.pretty_print_results_button.set_border_width(5);
+            page.pretty_print_results_button.signal_clicked().connect(
+                sigc::mem_fun(*this, &MainWindow::on_pretty_print_results_button_clicked));
+            page.box.pack_start(page.pretty_print_results_button, Gtk::PACK_SHRINK);
+
+            page.box.set_border_width(5);
+            results_tab.pack_start(page.box, Gtk::PACK_SHRINK);
+            results_tab.show_all_children();
+        }
+        break;
+    case 3:
+        if (awards_page) {
+            break;
+        }
+        awards_page.reset(new AwardsPage);
+        {
+            auto &page = *awards_page;
+            page.list.set_column_title(ALC_PLACE, "Place");
+            page.list.set_column_title(ALC_OVERALL, "Overall");
+            page.list.set_column_title(ALC_TEAM, "Team");
+            page.list.set_column_title(ALC_NAME, "Name");
+            page.list.set_column_title(ALC_TIME, "Time");
+            page.window.add(page.list);
+
+            for (auto &category : awards.categories) {
+                page.category.append(category.label);
+            }
+            page.category.signal_changed().connect(
+                sigc::mem_fun(*this, &MainWindow::on_award_category_changed));
+            page.category.set_active(0);
+
+            page.box.pack_start(page.category, Gtk::PACK_SHRINK);
+            page.box.pack_start(page.window, Gtk::PACK_EXPAND_WIDGET);
+            page.box.set_border_width(5);
+            awards_tab.pack_start(page.box, Gtk::PACK_EXPAND_WIDGET);
+            awards_tab.show_all_children();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Back on the GUI thread once the preload thread is through.
+void MainWindow::on_preload_done() {
+    finish_preload(true);
+}
+
+// Waits for the preload and, when `apply` is set, takes what it loaded.
+void MainWindow::finish_preload(bool apply) {
+    if (preload_thread.joinable()) {
+        preload_thread.join();
+    }
+    if (!preload) {
+        return;
+    }
+    auto &p = *preload;
+    if (apply && p.roster_loaded) {
+        w.runners = std::move(p.runners);
+        w.rosters = std::move(p.rosters);
+        w.teams = std::move(p.teams);
+        search_index = std::move(p.search_index);
+        // the index points at the containers, which have moved
+        search_index.runners = &w.runners;
+        search_index.rosters = &w.rosters;
+        reports.invalidate();
+        const auto now = std::chrono::steady_clock::now();
+        std::cout << "load roster: " << w.runners.size() << " runners in "
+            << std::chrono::duration<double, std::milli>(p.loaded - p.started).count() << " ms, ready "
+            << std::chrono::duration<double, std::milli>(now - p.started).count() << " ms after start\n";
+    }
+    if (apply && p.seeds_loaded) {
+        seeds = std::move(p.seeds);
+    }
+    // a race started before the preload landed is projecting an empty roster
+    if (apply && running && (p.roster_loaded || p.seeds_loaded)) {
+        start_projection(w.rosters, seeds, projection);
+        projected_finishes = 0;
+        update_projection();
+    }
+    preload.reset();
+}
+
+// A button press is a runner crossing the line: stamp it against the gun.
+bool MainWindow::on_poll_joystick() {
+    SDL_JoystickUpdate();
+    for (std::size_t i = 0; i < buttons.size(); i++) {
+        const auto state = SDL_JoystickGetButton(js, i);
+        if (state && !buttons[i]) {
+            recorder.record(EventKind::Button, i);
+            if (running) {
+                const auto elapsed = std::chrono::steady_clock::now() - gun;
+                w.times.push_back(std::chrono::duration<float>(elapsed).count());
+                Mix_PlayChannel(-1, beep, 0);
+                update_projection();
+            }
+        }
+        buttons[i] = state;
+    }
+    return true;
+}
 
 void MainWindow::on_load_config_button_clicked() {
     std::cout << "load config\n";
 }
 
 void MainWindow::on_load_roster_button_clicked() {
-    if (!import_rosters_v1("roster.txt", w.rosters, w.teams, w.runners)) {
-        std::cout << "can't load roster\n";
+    recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::LoadRoster));
+    finish_preload(true);
+    if (w.runners.empty()) {
+        if (!import_rosters_v2("roster.txt", w.rosters, w.teams, w.runners)) {
+            std::cout << "can't load roster\n";
+        } else {
+            std::cout << "load roster\n";
+            build_search_index(w.runners, w.rosters, w.teams, search_index);
+            reports.invalidate();
+        }
     } else {
-        std::cout << "load roster\n";
+        // late entries and scratches: ids stay put, and the live standings
+        // project the whole roster, so they're replayed on any change
+        RosterDiff diff;
+        if (!reload_roster("roster.txt", w.rosters, w.teams, w.runners, diff)) {
+            std::cout << "can't reload roster\n";
+        } else {
+            std::cout << "reload roster: " << diff << '\n';
+            if (!empty(diff)) {
+                build_search_index(w.runners, w.rosters, w.teams, search_index);
+                reports.invalidate();
+                start_projection(w.rosters, seeds, projection);
+                projected_finishes = 0;
+                update_projection();
+            }
+        }
+    }
+    if (!import_seeds("seeds.txt", seeds)) {
+        std::cout << "no seed times, projecting finishers only\n";
+    }
+}
+
+// Typed as the runner comes to the table, so this runs on every keystroke.
+void MainWindow::on_search_changed() {
+    search_list.clear_items();
+    search_runners(search_index, search_entry.get_text(), 50, search_matches);
+    for (auto runner_id : search_matches) {
+        auto row = search_list.append();
+        search_list.set_text(row, SLC_BIB, std::to_string(runner_id));
+        // a stale index entry leaves its cells blank; operator[] would
+        // add a blank runner or team to the roster being scored
+        auto team_id = w.rosters.runner_to_team.find(runner_id);
+        if (team_id != w.rosters.runner_to_team.end()) {
+            auto team = w.teams.find(team_id->second);
+            if (team != w.teams.end()) {
+                search_list.set_text(row, SLC_TEAM, team->second.initials);
+            }
+        }
+        auto runner = w.runners.find(runner_id);
+        if (runner != w.runners.end()) {
+            search_list.set_text(row, SLC_NAME, runner->second.name);
+        }
     }
 }
 
 void MainWindow::on_start_button_clicked() {
+    recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::Start));
+    gun = std::chrono::steady_clock::now();
+    running = true;
+    start_projection(w.rosters, seeds, projection);
+    projected_finishes = 0;
+    results_list.clear_items();
     std::cout << "start\n";
     results_frame.show();
 }
@@ -173,6 +367,8 @@ void MainWindow::on_stop_button_clicked() {
     switch (ok_or_cancel) {
     // stop!
     case -5:
+        recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::Stop));
+        running = false;
         std::cout << "stop\n";
         break;
     // don't stop
@@ -185,21 +381,150 @@ void MainWindow::on_stop_button_clicked() {
 }
 
 void MainWindow::on_load_barcodes_button_clicked() {
-    if (!import_barcodes_v1("barcodes.txt", w.barcodes)) {
+    recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::LoadBarcodes));
+    if (!import_barcodes_v2("barcodes.txt", w.barcodes)) {
         std::cout << "can't load barcodes\n";
     } else {
+        // the scanner's output only reaches us through its file
+        for (auto runner_id : w.barcodes) {
+            recorder.record(EventKind::Barcode, runner_id);
+        }
         std::cout << "load barcodes\n";
+        update_projection();
+    }
+}
+
+// Every finish that has both a time and a barcode moves the projection on.
+void MainWindow::update_projection() {
+    const auto known = std::min(w.times.size(), w.barcodes.size());
+    if (projected_finishes == known) {
+        return;
+    }
+    for (; projected_finishes < known; projected_finishes++) {
+        project_finish(w.barcodes[projected_finishes], w.times[projected_finishes], projection);
+    }
+    feed.publish(w.rosters, w.teams, w.runners, projection.actual, projection.actual_results);
+
+    std::map<TeamId, const Result *> actual;
+    for (auto &result : projection.actual_results) {
+        actual[result.team_id] = &result;
+    }
+    auto both = [] (unsigned int projected, unsigned int now) {
+        std::stringstream ss;
+        ss << projected << " (";
+        if (now) {
+            ss << now;
+        } else {
+            ss << '-';
+        }
+        ss << ')';
+        return ss.str();
+    };
+
+    results_list.clear_items();
+    for (auto &result : projection.projected_results) {
+        if (!result.squad.score) {
+            continue;
+        }
+        const auto now = actual.count(result.team_id) ? actual[result.team_id] : nullptr;
+        const bool scoring = now && now->squad.score;
+        std::stringstream places;
+        for (unsigned int i = 0; i < Nfhs::displacers && i < result.squad.places.size(); i++) {
+            places << result.squad.places[i].place_number << ' ';
+        }
+        std::stringstream time;
+        time << result.squad.time;
+
+        auto row = results_list.append();
+        results_list.set_text(row, RLC_PLACE, both(result.place, scoring ? now->place : 0));
+        results_list.set_text(row, RLC_SCORE, both(result.squad.score, scoring ? now->squad.score : 0));
+        results_list.set_text(row, RLC_TIME, time.str());
+        auto team = w.teams.find(result.team_id);
+        if (team != w.teams.end()) {
+            results_list.set_text(row, RLC_TEAM, team->second.initials);
+        }
+        results_list.set_text(row, RLC_PLACE_NUMBERS, places.str());
+    }
+
+    update_awards();
+}
+
+// One pass over the finishes so far ranks every category at once.
+void MainWindow::update_awards() {
+    const auto shown = awards.categories.size();
+    rank_categories(w.rosters, w.teams, w.runners, projection.actual, 15, awards);
+    if (!awards_page) {
+        return;
+    }
+    auto &category = awards_page->category;
+    if (awards.categories.size() != shown) {
+        category.remove_all();
+        for (auto &entry : awards.categories) {
+            category.append(entry.label);
+        }
+        category.set_active(0);
+    } else {
+        on_award_category_changed();
+    }
+}
+
+void MainWindow::on_award_category_changed() {
+    if (!awards_page) {
+        return;
+    }
+    auto &list = awards_page->list;
+    list.clear_items();
+    const auto category = awards_page->category.get_active_row_number();
+    if (category < 0 || static_cast<std::size_t>(category) >= awards.categories.size()) {
+        return;
+    }
+    for (auto &place : awards.places[category]) {
+        std::stringstream time;
+        time << place.time;
+
+        auto row = list.append();
+        list.set_text(row, ALC_PLACE, std::to_string(place.place));
+        list.set_text(row, ALC_OVERALL, std::to_string(place.overall));
+        // find, not operator[]: display code mustn't add to the roster
+        auto team_id = w.rosters.runner_to_team.find(place.runner_id);
+        if (team_id != w.rosters.runner_to_team.end()) {
+            auto team = w.teams.find(team_id->second);
+            if (team != w.teams.end()) {
+                list.set_text(row, ALC_TEAM, team->second.initials);
+            }
+        }
+        auto runner = w.runners.find(place.runner_id);
+        if (runner != w.runners.end()) {
+            list.set_text(row, ALC_NAME, runner->second.name);
+        }
+        list.set_text(row, ALC_TIME, time.str());
     }
 }
 
 void MainWindow::on_load_results_button_clicked() {
+    recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::LoadResults));
     std::cout << "load results\n";
 }
 
 void MainWindow::on_export_results_button_clicked() {
-    std::cout << "export results\n";
+    recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::ExportResults));
+    std::vector<ReportJob> jobs;
+    add_report_jobs(w, "results", jobs);
+    BatchStats stats;
+    if (!write_reports(jobs, stats)) {
+        std::cout << "can't export results\n";
+    } else {
+        std::cout << "export results: " << stats << '\n';
+    }
+    std::ofstream awards_file("results_awards.txt");
+    if (!awards_file.is_open()) {
+        std::cout << "can't export awards\n";
+    } else {
+        output_awards(awards_file, w, 15);
+    }
 }
 
 void MainWindow::on_pretty_print_results_button_clicked() {
-    std::cout << w;
+    recorder.record(EventKind::Gui, static_cast<std::int32_t>(GuiAction::PrettyPrintResults));
+    reports.output(std::cout, w);
 }
@@ -1,6 +1,16 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "categories.hpp"
+#include "feed.hpp"
+#include "projection.hpp"
+#include "reload.hpp"
+#include "report.hpp"
+#include "search.hpp"
+#include "trace.hpp"
 #include "wildcat.hpp"
 #include <gtkmm.h>
 #include <gtkmm/button.h>
@@ -20,6 +30,59 @@ enum RaceListColumn : guint {
     RLC_COUNT
 };
 
+enum SearchListColumn : guint {
+    SLC_BIB = 0,
+    SLC_TEAM,
+    SLC_NAME,
+    SLC_COUNT
+};
+
+enum AwardListColumn : guint {
+    ALC_PLACE = 0,
+    ALC_OVERALL,
+    ALC_TEAM,
+    ALC_NAME,
+    ALC_TIME,
+    ALC_COUNT
+};
+
+// The pages past the race page are built the first time their tab is
+// shown; a cold start only needs the race page and the clock.
+struct ConfigPage {
+    Gtk::VBox box;
+    Gtk::Button load_config_button{"Load Config"};
+    Gtk::Button load_roster_button{"Load Roster"};
+};
+
+struct ResultsPage {
+    Gtk::VBox box;
+    Gtk::Button load_barcodes_button{"Load Barcodes"};
+    Gtk::Button load_results_button{"Load Results"};
+    Gtk::Button export_results_button{"Export Results"};
+    Gtk::Button pretty_print_results_button{"Pretty Print Results"};
+};
+
+struct AwardsPage {
+    Gtk::VBox box;
+    Gtk::ComboBoxText category;
+    Gtk::ScrolledWindow window;
+    Gtk::ListViewText list{ALC_COUNT};
+};
+
+// The last meet's roster, seeds and search index, loaded off the GUI
+// thread while the window comes up.
+struct Preload {
+    Runners runners;
+    Rosters rosters;
+    Teams teams;
+    std::vector<SeedTime> seeds;
+    SearchIndex search_index;
+    bool roster_loaded = false;
+    bool seeds_loaded = false;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point loaded;
+};
+
 class MainWindow : public Gtk::Window {
 public:
     MainWindow(SDL_Joystick *js, Mix_Chunk *beep);
@@ -34,6 +97,14 @@ protected:
     void on_load_results_button_clicked();
     void on_export_results_button_clicked();
     void on_pretty_print_results_button_clicked();
+    bool on_poll_joystick();
+    void on_search_changed();
+    void update_projection();
+    void update_awards();
+    void on_award_category_changed();
+    void on_switch_page(Gtk::Widget *page, guint page_number);
+    void on_preload_done();
+    void finish_preload(bool apply);
 
 private:
     Gtk::Paned main_divider;
@@ -43,17 +114,14 @@ private:
     Gtk::ScrolledWindow race_page;
     Gtk::ListViewText race_list;
 
-    Gtk::Grid config_page;
-    Gtk::Button load_config_button;
-    Gtk::Button load_roster_button;
-    Gtk::VBox config_box;
+    Gtk::VBox config_tab;
+    std::unique_ptr<ConfigPage> config_page;
+
+    Gtk::VBox results_tab;
+    std::unique_ptr<ResultsPage> results_page;
 
-    Gtk::Grid results_page;
-    Gtk::Button load_barcodes_button;
-    Gtk::Button load_results_button;
-    Gtk::Button export_results_button;
-    Gtk::Button pretty_print_results_button;
-    Gtk::VBox results_box;
+    Gtk::VBox awards_tab;
+    std::unique_ptr<AwardsPage> awards_page;
 
     Gtk::VBox right_vbox;
     
@@ -70,11 +138,32 @@ private:
     Gtk::ListViewText results_list;
     Gtk::Frame results_frame;
 
+    Gtk::Frame search_frame;
+    Gtk::VBox search_vbox;
+    Gtk::SearchEntry search_entry;
+    Gtk::ScrolledWindow search_window;
+    Gtk::ListViewText search_list;
+
     Gtk::MessageDialog quit_dialog;
 
     SDL_Joystick *js;
     Mix_Chunk *beep;
+    std::vector<Uint8> buttons;
+    bool running;
+    std::chrono::steady_clock::time_point gun;
+    TraceRecorder recorder;
     Wildcat w;
+    ReportCache<> reports;
+    std::vector<SeedTime> seeds;
+    Projection projection;
+    std::size_t projected_finishes;
+    FeedPublisher feed;
+    SearchIndex search_index;
+    std::vector<RunnerId> search_matches;
+    CategoryRankings awards;
+    std::unique_ptr<Preload> preload;
+    std::thread preload_thread;
+    Glib::Dispatcher preload_done;
 };
 
 #endif
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "parse.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PARSE_X86 1
+#endif
+
+namespace {
+
+// Each scanner writes at most one offset per input byte, so callers size the
+// output for a whole block up front and trim it afterwards.
+std::uint32_t *index_fields_scalar(const char *data, std::size_t begin, std::size_t end, std::uint32_t base, std::uint32_t *out) {
+    for (auto i = begin; i < end; i++) {
+        *out = base + static_cast<std::uint32_t>(i);
+        out += data[i] == '\t' || data[i] == '\n';
+    }
+    return out;
+}
+
+#ifdef PARSE_X86
+__attribute__((target("sse2")))
+std::uint32_t *index_fields_sse2(const char *data, std::size_t size, std::uint32_t base, std::uint32_t *out) {
+    const auto tab = _mm_set1_epi8('\t');
+    const auto newline = _mm_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const auto hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, tab), _mm_cmpeq_epi8(chunk, newline));
+        auto mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+        while (mask) {
+            *out++ = base + static_cast<std::uint32_t>(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return index_fields_scalar(data, i, size, base, out);
+}
+
+__attribute__((target("avx2")))
+std::uint32_t *index_fields_avx2(const char *data, std::size_t size, std::uint32_t base, std::uint32_t *out) {
+    const auto tab = _mm256_set1_epi8('\t');
+    const auto newline = _mm256_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const auto hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, tab), _mm256_cmpeq_epi8(chunk, newline));
+        auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(hits));
+        while (mask) {
+            *out++ = base + static_cast<std::uint32_t>(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return index_fields_scalar(data, i, size, base, out);
+}
+#endif
+
+using IndexBlock = std::uint32_t *(*)(const char *, std::size_t, std::uint32_t, std::uint32_t *);
+
+std::uint32_t *index_block_scalar(const char *data, std::size_t size, std::uint32_t base, std::uint32_t *out) {
+    return index_fields_scalar(data, 0, size, base, out);
+}
+
+IndexBlock index_block() {
+    switch (scan_isa()) {
+#ifdef PARSE_X86
+    case ScanIsa::Avx2: return index_fields_avx2;
+    case ScanIsa::Sse2: return index_fields_sse2;
+#endif
+    default: return index_block_scalar;
+    }
+}
+
+const std::size_t block_size = 64 * 1024;
+
+ScanIsa detect_scan_isa() {
+#ifdef PARSE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ScanIsa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return ScanIsa::Sse2;
+    }
+#endif
+    return ScanIsa::Scalar;
+}
+
+// Powers of ten that are exact in a float, so a mantissa below 2^24
+// divided by one of them rounds exactly like std::stof would.
+const float exact_powers_of_ten[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+void trim(const char *&begin, const char *&end) {
+    while (begin < end && (*begin == ' ' || *begin == '\r')) {
+        begin++;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\r')) {
+        end--;
+    }
+}
+
+} // namespace
+
+ScanIsa scan_isa() {
+    static const auto isa = detect_scan_isa();
+    return isa;
+}
+
+void index_fields(const char *data, std::size_t size, std::vector<std::uint32_t> &delims) {
+    static const auto scan = index_block();
+    for (std::size_t begin = 0; begin < size; begin += block_size) {
+        const auto length = std::min(block_size, size - begin);
+        const auto used = delims.size();
+        delims.resize(used + length);
+        const auto end = scan(data + begin, length, static_cast<std::uint32_t>(begin), delims.data() + used);
+        delims.resize(end - delims.data());
+    }
+}
+
+bool parse_int(const char *begin, const char *end, int &value) {
+    trim(begin, end);
+
+    bool negative = false;
+    if (begin < end && (*begin == '-' || *begin == '+')) {
+        negative = *begin == '-';
+        begin++;
+    }
+    if (begin == end) {
+        return false;
+    }
+
+    long long n = 0;
+    for (; begin < end; begin++) {
+        const auto digit = static_cast<unsigned char>(*begin - '0');
+        if (digit > 9) {
+            return false;
+        }
+        n = n * 10 + digit;
+        if (n > 2147483648LL) {
+            return false;
+        }
+    }
+    if (negative) {
+        n = -n;
+    }
+    if (n > 2147483647LL) {
+        return false;
+    }
+    value = static_cast<int>(n);
+    return true;
+}
+
+bool parse_seconds(const char *begin, const char *end, float &seconds) {
+    trim(begin, end);
+    if (begin == end) {
+        return false;
+    }
+
+    unsigned long long mantissa = 0;
+    unsigned int digits = 0;
+    int scale = -1;
+    for (; begin < end; begin++) {
+        if (*begin == '.' && scale < 0) {
+            scale = 0;
+            continue;
+        }
+        const auto digit = static_cast<unsigned char>(*begin - '0');
+        if (digit > 9 || digits == 18) {
+            return false;
+        }
+        mantissa = mantissa * 10 + digit;
+        digits++;
+        if (scale >= 0) {
+            scale++;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (scale < 0) {
+        scale = 0;
+    }
+
+    if (mantissa < (1u << 24) && scale <= 10) {
+        seconds = static_cast<float>(mantissa) / exact_powers_of_ten[scale];
+    } else {
+        double divisor = 1;
+        for (auto i = 0; i < scale; i++) {
+            divisor *= 10;
+        }
+        seconds = static_cast<float>(mantissa / divisor);
+    }
+    return true;
+}
+
+void put_varint(std::string &out, std::uint64_t n) {
+    while (n >= 0x80) {
+        out.push_back(static_cast<char>((n & 0x7F) | 0x80));
+        n >>= 7;
+    }
+    out.push_back(static_cast<char>(n));
+}
+
+bool get_varint(const std::string &in, std::size_t &pos, std::uint64_t &n) {
+    const char *p = in.data() + pos;
+    const bool ok = get_varint(p, in.data() + in.size(), n);
+    pos = p - in.data();
+    return ok;
+}
+
+bool get_varint(const char *&p, const char *end, std::uint64_t &n) {
+    n = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            return false;
+        }
+        const auto byte = static_cast<unsigned char>(*p++);
+        n |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool read_file(const std::string &path, std::string &contents) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const auto size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (size < 0 || !file || static_cast<unsigned long long>(size) > contents.max_size()) {
+        std::cerr << "read_file(): Can't size \"" << path << "\"\n";
+        return false;
+    }
+    contents.resize(static_cast<std::size_t>(size));
+    file.read(&contents[0], contents.size());
+    // a short read would otherwise parse as a truncated file
+    if (static_cast<std::size_t>(file.gcount()) != contents.size()) {
+        std::cerr << "read_file(): Read " << file.gcount() << " of " << contents.size()
+            << " bytes of \"" << path << "\"\n";
+        contents.clear();
+        return false;
+    }
+    return true;
+}
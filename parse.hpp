@@ -0,0 +1,37 @@
+#ifndef PARSE_HPP
+#define PARSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Which SIMD width index_fields() and compute_net_times() dispatch to on
+// this CPU.
+enum class ScanIsa {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+ScanIsa scan_isa();
+
+// Appends the offset of every '\t' and '\n' in [data, data + size) to delims.
+// Fields are the spans between consecutive delimiters; the byte at each
+// offset tells whether it ends a field or a whole record.
+void index_fields(const char *data, std::size_t size, std::vector<std::uint32_t> &delims);
+
+// Exact, exception-free parsers. A trailing '\r' is accepted; anything else
+// that isn't part of the number makes them return false.
+bool parse_int(const char *begin, const char *end, int &value);
+bool parse_seconds(const char *begin, const char *end, float &seconds);
+
+// LEB128: seven bits a byte, low bits first. get_varint() advances pos
+// (or p) past the number and returns false if it runs off the end.
+void put_varint(std::string &out, std::uint64_t n);
+bool get_varint(const std::string &in, std::size_t &pos, std::uint64_t &n);
+bool get_varint(const char *&p, const char *end, std::uint64_t &n);
+
+bool read_file(const std::string &path, std::string &contents);
+
+#endif
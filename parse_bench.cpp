@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include "parse.hpp"
+#include "wildcat.hpp"
+
+// parse-bench [lines] [scratch dir]
+//
+// Times the import paths against each other on generated files of
+// `lines` records (300000 by default) written to the scratch directory
+// (/tmp by default): the delimiter index against a byte loop, and each
+// v2 importer against its v1 reference. Each v2 result must match v1's,
+// or the bench fails. Every figure is the best of a few warm runs.
+
+static const int runs = 5;
+
+template <typename F>
+static double best_ms(F f) {
+    double best = 1e300;
+    for (auto i = 0; i < runs; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto took = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, took);
+    }
+    return best;
+}
+
+static void write_files(const std::string &dir, unsigned int lines) {
+    std::mt19937 random(42);
+    std::ofstream roster(dir + "/bench_roster.txt");
+    std::ofstream barcodes(dir + "/bench_barcodes.txt");
+    std::ofstream times(dir + "/bench_times.txt");
+    const unsigned int team_count = 40;
+    for (unsigned int i = 0; i < lines; i++) {
+        const auto bib = 1000 + i;
+        roster << bib << "\tRunner " << i << "\tTeam " << random() % team_count << '\t'
+            << 9 + random() % 4 << '\t' << (random() % 2 ? 'G' : 'B') << '\n';
+        barcodes << bib << '\n';
+        times << i << "\t0\t1\t00\t0\t0\t" << 900 + i * 0.01 << '\n';
+    }
+}
+
+int main(int argc, char **argv) {
+    const unsigned int lines = argc > 1 ? std::atoi(argv[1]) : 300000;
+    const std::string dir = argc > 2 ? argv[2] : "/tmp";
+    write_files(dir, lines);
+
+    std::string contents;
+    if (!read_file(dir + "/bench_times.txt", contents)) {
+        return EXIT_FAILURE;
+    }
+    std::vector<std::uint32_t> delims;
+    const auto indexed = best_ms([&] () {
+        delims.clear();
+        index_fields(contents.data(), contents.size(), delims);
+    });
+    std::size_t loop_count = 0;
+    const auto looped = best_ms([&] () {
+        loop_count = 0;
+        for (auto c : contents) {
+            loop_count += c == '\t' || c == '\n';
+        }
+    });
+    if (loop_count != delims.size()) {
+        std::cerr << "parse-bench: index_fields() found " << delims.size() << " delimiters, not " << loop_count << '\n';
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    std::vector<float> times_v1, times_v2;
+    const auto times_ms_v1 = best_ms([&] () { ok = import_times_v1(dir + "/bench_times.txt", times_v1) && ok; });
+    const auto times_ms_v2 = best_ms([&] () { ok = import_times_v2(dir + "/bench_times.txt", times_v2) && ok; });
+    std::vector<RunnerId> barcodes_v1, barcodes_v2;
+    const auto barcodes_ms_v1 = best_ms([&] () { ok = import_barcodes_v1(dir + "/bench_barcodes.txt", barcodes_v1) && ok; });
+    const auto barcodes_ms_v2 = best_ms([&] () { ok = import_barcodes_v2(dir + "/bench_barcodes.txt", barcodes_v2) && ok; });
+    Rosters rosters_v1, rosters_v2;
+    Teams teams_v1, teams_v2;
+    Runners runners_v1, runners_v2;
+    const auto rosters_ms_v1 = best_ms([&] () {
+        ok = import_rosters_v1(dir + "/bench_roster.txt", rosters_v1, teams_v1, runners_v1) && ok;
+    });
+    const auto rosters_ms_v2 = best_ms([&] () {
+        ok = import_rosters_v2(dir + "/bench_roster.txt", rosters_v2, teams_v2, runners_v2) && ok;
+    });
+    if (!ok) {
+        return EXIT_FAILURE;
+    }
+    if (times_v1 != times_v2 || barcodes_v1 != barcodes_v2 ||
+        rosters_v1.runner_to_team != rosters_v2.runner_to_team || runners_v1.size() != runners_v2.size()) {
+        std::cerr << "parse-bench: v2 import differs from v1\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << lines << " lines, " << (scan_isa() == ScanIsa::Avx2 ? "avx2" : scan_isa() == ScanIsa::Sse2 ? "sse2" : "scalar")
+        << " scanner\n"
+        << "delimiters   " << indexed << " ms (byte loop " << looped << " ms)\n"
+        << "times        " << times_ms_v2 << " ms (v1 " << times_ms_v1 << " ms)\n"
+        << "barcodes     " << barcodes_ms_v2 << " ms (v1 " << barcodes_ms_v1 << " ms)\n"
+        << "roster       " << rosters_ms_v2 << " ms (v1 " << rosters_ms_v1 << " ms)\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include "parse.hpp"
+#include "projection.hpp"
+
+static void fenwick_add(std::vector<std::int32_t> &tree, std::size_t slot, std::int32_t delta) {
+    for (auto i = slot + 1; i <= tree.size(); i += i & (0 - i)) {
+        tree[i - 1] += delta;
+    }
+}
+
+// how many of slots 0 through `slot` are set
+static unsigned int fenwick_count(const std::vector<std::int32_t> &tree, std::size_t slot) {
+    std::int32_t count = 0;
+    for (auto i = slot + 1; i > 0; i -= i & (0 - i)) {
+        count += tree[i - 1];
+    }
+    return static_cast<unsigned int>(count);
+}
+
+template <typename Rules>
+static void project_squad(const Projection &projection, const ProjectedTeam &team, Squad &squad) {
+    const bool full = team.members.size() >= Rules::minimum_squad;
+    squad.score = 0;
+    squad.time = Time(0);
+    squad.places.clear();
+    for (std::size_t i = 0; i < team.members.size() && i < Rules::displacers; i++) {
+        auto &runner = projection.runners[team.members[i]];
+        squad.places.push_back({
+            .runner_id = runner.runner_id,
+            .place_number = fenwick_count(projection.occupied, runner.slot),
+        });
+        if (full && i < Rules::scorers) {
+            const bool finished = runner.slot < projection.runners.size();
+            squad.score += fenwick_count(projection.counted, runner.slot);
+            squad.time = squad.time + Time(finished ? runner.seconds : std::max(runner.seconds, projection.now));
+        }
+    }
+}
+
+// Orders the results as score_race() does and tells each team where it went.
+template <typename Rules>
+static void rank_results(Results &results, std::uint32_t ProjectedTeam::*result, Projection &projection) {
+    std::stable_sort(results.begin(), results.end(), [] (const Result &a, const Result &b) {
+        return trails<Rules>(b.squad, a.squad);
+    });
+    unsigned int place = 1;
+    for (std::uint32_t i = 0; i < results.size(); i++) {
+        results[i].place = place;
+        if (results[i].squad.score != 0) {
+            place++;
+        }
+        const auto t = std::lower_bound(projection.team_ids.begin(), projection.team_ids.end(), results[i].team_id) -
+            projection.team_ids.begin();
+        projection.teams[t].*result = i;
+    }
+}
+
+template <typename Rules>
+void start_projection(const Rosters &rosters, const std::vector<SeedTime> &seeds, Projection &projection) {
+    projection = Projection();
+
+    std::map<RunnerId, float> seed_times;
+    float slowest = 0;
+    for (auto &seed : seeds) {
+        if (rosters.runner_to_team.count(seed.runner_id)) {
+            seed_times[seed.runner_id] = seed.mean;
+            slowest = std::max(slowest, seed.mean);
+        }
+    }
+
+    std::vector<bool> seeded;
+    for (auto &team : rosters.team_to_runners) {
+        const auto t = static_cast<std::uint32_t>(projection.team_ids.size());
+        projection.team_ids.push_back(team.first);
+        projection.teams.push_back({ {}, 0, t, t });
+        for (auto runner_id : team.second) {
+            const auto r = static_cast<std::uint32_t>(projection.runners.size());
+            if (!projection.runner_index.insert(std::make_pair(runner_id, r)).second) {
+                continue;
+            }
+            auto seed = seed_times.find(runner_id);
+            seeded.push_back(seed != seed_times.end());
+            projection.runners.push_back({ runner_id, t, 0, 0, seeded.back() ? seed->second : slowest });
+            projection.teams[t].members.push_back(r);
+        }
+    }
+
+    auto &runners = projection.runners;
+    std::vector<std::uint32_t> by_seed(runners.size());
+    for (std::uint32_t r = 0; r < by_seed.size(); r++) {
+        by_seed[r] = r;
+    }
+    std::stable_sort(by_seed.begin(), by_seed.end(), [&] (std::uint32_t a, std::uint32_t b) {
+        return std::make_pair(!seeded[a], runners[a].seconds) < std::make_pair(!seeded[b], runners[b].seconds);
+    });
+
+    projection.occupied.assign(2 * runners.size(), 0);
+    projection.counted.assign(2 * runners.size(), 0);
+    for (std::uint32_t rank = 0; rank < by_seed.size(); rank++) {
+        runners[by_seed[rank]].slot = static_cast<std::uint32_t>(runners.size()) + rank;
+        fenwick_add(projection.occupied, runners[by_seed[rank]].slot, 1);
+    }
+
+    for (auto &team : projection.teams) {
+        std::sort(team.members.begin(), team.members.end(), [&] (std::uint32_t a, std::uint32_t b) {
+            return runners[a].slot < runners[b].slot;
+        });
+        if (team.members.size() < Rules::minimum_squad) {
+            continue;
+        }
+        for (std::size_t i = 0; i < team.members.size() && i < Rules::displacers; i++) {
+            fenwick_add(projection.counted, runners[team.members[i]].slot, 1);
+        }
+    }
+
+    for (std::uint32_t t = 0; t < projection.teams.size(); t++) {
+        projection.actual_results.push_back({ 0, projection.team_ids[t], Squad{ 0, Time(0), {} } });
+        projection.projected_results.push_back({ 0, projection.team_ids[t], Squad{ 0, Time(0), {} } });
+        project_squad<Rules>(projection, projection.teams[t], projection.projected_results.back().squad);
+    }
+    rank_results<Rules>(projection.actual_results, &ProjectedTeam::actual_result, projection);
+    rank_results<Rules>(projection.projected_results, &ProjectedTeam::projected_result, projection);
+}
+
+template <typename Rules>
+void project_finish(RunnerId runner_id, float seconds, Projection &projection) {
+    auto &runners = projection.runners;
+    auto found = projection.runner_index.find(runner_id);
+    if (found == projection.runner_index.end() || runners[found->second].slot < runners.size()) {
+        return;
+    }
+    auto &runner = runners[found->second];
+    auto &team = projection.teams[runner.team];
+    auto &members = team.members;
+    const auto slot = static_cast<std::uint32_t>(projection.actual.size());
+    const bool full = members.size() >= Rules::minimum_squad;
+
+    // Projected: the runner leaves its seed slot for the next finish slot,
+    // passing only its own teammates still out. If it passes into the
+    // displacers, the teammate who was projected last of them drops out.
+    const auto position = static_cast<std::size_t>(
+        std::find(members.begin() + team.finished, members.end(), found->second) - members.begin());
+    fenwick_add(projection.occupied, runner.slot, -1);
+    fenwick_add(projection.occupied, slot, 1);
+    if (full && position < Rules::displacers) {
+        fenwick_add(projection.counted, runner.slot, -1);
+        fenwick_add(projection.counted, slot, 1);
+    } else if (full && team.finished < Rules::displacers) {
+        fenwick_add(projection.counted, runners[members[Rules::displacers - 1]].slot, -1);
+        fenwick_add(projection.counted, slot, 1);
+    }
+    std::rotate(members.begin() + team.finished, members.begin() + position, members.begin() + position + 1);
+    runner.slot = slot;
+    runner.seconds = seconds;
+    runner.team_finish = team.finished++;
+    projection.now = std::max(projection.now, seconds);
+
+    // every place and score number ahead of the new slot stands, so only
+    // squads with a displacer at or behind it change
+    for (auto &other : projection.teams) {
+        if (other.members.empty()) {
+            continue;
+        }
+        const auto last = std::min<std::size_t>(other.members.size(), Rules::displacers) - 1;
+        if (runners[other.members[last]].slot >= slot) {
+            project_squad<Rules>(projection, other, projection.projected_results[other.projected_result].squad);
+        }
+    }
+
+    // Actual: the finish goes on the end. It takes the next score number,
+    // unless it completes its squad; then the squad's first runners start
+    // displacing and everyone scored behind its first finisher moves back.
+    auto &actual = projection.actual;
+    actual.push_back({ runner_id, Time(seconds), 0 });
+    auto &squad = projection.actual_results[team.actual_result].squad;
+    squad.places.push_back({
+        .runner_id = runner_id,
+        .place_number = slot + 1,
+    });
+    if (team.finished > Rules::minimum_squad && runner.team_finish < Rules::displacers) {
+        actual.back().score = ++projection.actual_counted;
+    } else if (team.finished == Rules::minimum_squad) {
+        const std::size_t from = squad.places.front().place_number - 1;
+        unsigned int score_num = 0;
+        for (auto i = from; i-- > 0; ) {
+            if (actual[i].score) {
+                score_num = actual[i].score;
+                break;
+            }
+        }
+        std::size_t own = 0;
+        for (auto i = from; i < actual.size(); i++) {
+            const bool displaces = own < Rules::displacers && own < squad.places.size() &&
+                squad.places[own].place_number == i + 1;
+            own += displaces;
+            if (displaces || actual[i].score) {
+                actual[i].score = ++score_num;
+            }
+        }
+        projection.actual_counted = score_num;
+
+        for (auto &other : projection.teams) {
+            auto &rescored = projection.actual_results[other.actual_result].squad;
+            if (other.finished < Rules::minimum_squad || rescored.places[Rules::scorers - 1].place_number <= from) {
+                continue;
+            }
+            rescored.score = 0;
+            rescored.time = Time(0);
+            for (unsigned int i = 0; i < Rules::scorers; i++) {
+                auto &finish = actual[rescored.places[i].place_number - 1];
+                rescored.score += finish.score;
+                rescored.time = rescored.time + finish.time;
+            }
+        }
+    }
+
+    rank_results<Rules>(projection.actual_results, &ProjectedTeam::actual_result, projection);
+    rank_results<Rules>(projection.projected_results, &ProjectedTeam::projected_result, projection);
+}
+
+void seeds_from_season(const Season &season, std::vector<SeedTime> &seeds) {
+    seeds.clear();
+    for (auto &runner : season.runners) {
+        if (runner.second.races) {
+            seeds.push_back({ runner.first, runner.second.best, 0 });
+        }
+    }
+}
+
+bool import_seeds(const std::string &seed_file, std::vector<SeedTime> &seeds) {
+
+    seeds.clear();
+
+    std::string contents;
+    if (!read_file(seed_file, contents)) {
+        std::cerr << "import_seeds(): No file \"" << seed_file << "\"\n";
+        return false;
+    }
+
+    std::istringstream in(contents);
+    std::string line;
+    unsigned int number = 0;
+    while (std::getline(in, line)) {
+        number++;
+        const auto tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        const auto spread = line.find('\t', tab + 1);
+        const auto seconds_end = spread == std::string::npos ? line.size() : spread;
+        SeedTime seed = { 0, 0, 0 };
+        if (!parse_int(line.data(), line.data() + tab, seed.runner_id) ||
+            !parse_seconds(line.data() + tab + 1, line.data() + seconds_end, seed.mean) ||
+            (spread != std::string::npos &&
+             !parse_seconds(line.data() + spread + 1, line.data() + line.size(), seed.deviation))) {
+            std::cerr << "import_seeds() with \"" << seed_file << "\" line " << number << ": \""
+                << line << "\" must be a runner, seconds and maybe a deviation.\n";
+            return false;
+        }
+        seeds.push_back(seed);
+    }
+    return true;
+}
+
+#define INSTANTIATE_PROJECTION(Rules) \
+    template void start_projection<Rules>(const Rosters &rosters, const std::vector<SeedTime> &seeds, Projection &projection); \
+    template void project_finish<Rules>(RunnerId runner_id, float seconds, Projection &projection);
+
+INSTANTIATE_PROJECTION(Nfhs)
+INSTANTIATE_PROJECTION(FourScorer)
+INSTANTIATE_PROJECTION(SixDisplacer)
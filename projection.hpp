@@ -0,0 +1,74 @@
+#ifndef PROJECTION_HPP
+#define PROJECTION_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "season.hpp"
+#include "simulate.hpp"
+#include "wildcat.hpp"
+
+// Mid-race standings as if everyone on the roster still on the course came
+// in behind the runners already finished: seeded runners in seed order,
+// then unseeded ones in roster order at the slowest seed time. A runner
+// whose projected time has already gone by is projected to finish right
+// now.
+//
+// Each runner holds a slot in the projected order: finishes take slots 0,
+// 1, 2... as they come in, and everyone still out holds slot (roster size
+// + seed rank), so a finish moves one runner and nobody else. Place and
+// score numbers are counts of slots, kept in two Fenwick trees, and each
+// team keeps its members in slot order. A finish then only rescores the
+// squads with a runner at or behind the new slot, and the actual standings
+// only append, except when a team reaches a full squad and its runners
+// start displacing.
+//
+// Projected squads list their first displacers' places, which is all the
+// scoring and tie-breaks read; actual squads list every finisher.
+struct ProjectedRunner {
+    RunnerId runner_id;
+    std::uint32_t team;
+    std::uint32_t slot;
+    std::uint32_t team_finish; // place within the team, once finished
+    float seconds;             // seed, then finish
+};
+
+struct ProjectedTeam {
+    std::vector<std::uint32_t> members; // in slot order, finishers first
+    std::uint32_t finished;
+    std::uint32_t actual_result;        // where the team is in each
+    std::uint32_t projected_result;     // of the results
+};
+
+struct Projection {
+    Finishes actual;
+    Results projected_results;
+    Results actual_results;
+
+    std::vector<TeamId> team_ids;
+    std::vector<ProjectedTeam> teams;
+    std::vector<ProjectedRunner> runners;
+    std::map<RunnerId, std::uint32_t> runner_index;
+    std::vector<std::int32_t> occupied; // slots anyone holds
+    std::vector<std::int32_t> counted;  // slots with a score number
+    unsigned int actual_counted = 0;
+    float now = 0;
+};
+
+template <typename Rules = Nfhs>
+void start_projection(const Rosters &rosters, const std::vector<SeedTime> &seeds, Projection &projection);
+
+// Moves both standings on by one finish. Runners not on the roster the
+// projection started from, and runners already finished, are ignored.
+template <typename Rules = Nfhs>
+void project_finish(RunnerId runner_id, float seconds, Projection &projection);
+
+// Season bests as seeds, for runners who have raced this season.
+void seeds_from_season(const Season &season, std::vector<SeedTime> &seeds);
+
+// One "<RunnerId>\t<seconds>[\t<deviation seconds>]" per line; the
+// deviation is 0 when left out.
+bool import_seeds(const std::string &seed_file, std::vector<SeedTime> &seeds);
+
+#endif
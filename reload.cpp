@@ -0,0 +1,150 @@
+#include <algorithm>
+#include "reload.hpp"
+
+std::ostream &operator<<(std::ostream &os, const RosterDiff &diff) {
+    os << diff.added.size() << " added, " << diff.removed.size() << " removed, "
+       << diff.moved.size() << " moved, " << diff.edited.size() << " edited, "
+       << diff.added_teams.size() << " new team(s), " << diff.removed_teams.size() << " team(s) gone, "
+       << diff.edited_teams.size() << " team(s) edited";
+    return os;
+}
+
+bool empty(const RosterDiff &diff) {
+    return diff.added.empty() && diff.removed.empty() && diff.moved.empty() && diff.edited.empty() &&
+        diff.added_teams.empty() && diff.removed_teams.empty() && diff.edited_teams.empty();
+}
+
+static bool same_runner(const Runner &a, const Runner &b) {
+    return a.name == b.name && a.klass == b.klass && a.gender == b.gender;
+}
+
+static bool same_team(const Team &a, const Team &b) {
+    return a.initials == b.initials && a.name == b.name && a.location == b.location;
+}
+
+bool reload_roster(const std::string &roster_file, Rosters &rosters, Teams &teams, Runners &runners, RosterDiff &diff) {
+
+    diff = RosterDiff();
+
+    Rosters fresh_rosters;
+    Teams fresh_teams;
+    Runners fresh_runners;
+    if (!import_rosters_v2(roster_file, fresh_rosters, fresh_teams, fresh_runners)) {
+        return false;
+    }
+
+    // the file's team ids are only its order; initials are what stay put
+    std::map<std::string, TeamId> by_initials;
+    TeamId next_id = rosters.next_team_id;
+    for (auto &team : teams) {
+        by_initials[team.second.initials] = team.first;
+        next_id = std::max(next_id, team.first + 1);
+    }
+    std::map<TeamId, TeamId> stable_ids;
+    for (auto &team : fresh_teams) {
+        auto found = by_initials.find(team.second.initials);
+        if (found != by_initials.end()) {
+            stable_ids[team.first] = found->second;
+            auto &loaded = teams[found->second];
+            if (!same_team(loaded, team.second)) {
+                loaded = team.second;
+                diff.edited_teams.push_back(found->second);
+            }
+            continue;
+        }
+        stable_ids[team.first] = next_id;
+        teams.insert(std::pair<TeamId, Team>(next_id, team.second));
+        rosters.team_to_runners.insert(std::pair<TeamId, std::vector<RunnerId>>(next_id, {}));
+        diff.added_teams.push_back(next_id);
+        diff.affected_teams.insert(next_id);
+        next_id++;
+    }
+    rosters.next_team_id = next_id;
+
+    auto leave = [&] (RunnerId runner_id, TeamId team_id) {
+        auto &members = rosters.team_to_runners[team_id];
+        members.erase(std::remove(members.begin(), members.end(), runner_id), members.end());
+        diff.affected_teams.insert(team_id);
+    };
+    auto join = [&] (RunnerId runner_id, TeamId team_id) {
+        rosters.runner_to_team[runner_id] = team_id;
+        rosters.team_to_runners[team_id].push_back(runner_id);
+        diff.affected_teams.insert(team_id);
+    };
+
+    for (auto runner = runners.begin(); runner != runners.end(); ) {
+        const auto runner_id = runner->first;
+        if (fresh_runners.count(runner_id)) {
+            ++runner;
+            continue;
+        }
+        auto team = rosters.runner_to_team.find(runner_id);
+        if (team != rosters.runner_to_team.end()) {
+            leave(runner_id, team->second);
+            rosters.runner_to_team.erase(team);
+        }
+        diff.removed.push_back(runner_id);
+        runner = runners.erase(runner);
+    }
+
+    for (auto &entry : fresh_runners) {
+        const auto runner_id = entry.first;
+        const auto team_id = stable_ids[fresh_rosters.runner_to_team.find(runner_id)->second];
+
+        auto loaded = runners.find(runner_id);
+        if (loaded == runners.end()) {
+            runners.insert(entry);
+            join(runner_id, team_id);
+            diff.added.push_back(runner_id);
+            continue;
+        }
+
+        auto team = rosters.runner_to_team.find(runner_id);
+        if (team == rosters.runner_to_team.end() || team->second != team_id) {
+            if (team != rosters.runner_to_team.end()) {
+                leave(runner_id, team->second);
+            }
+            join(runner_id, team_id);
+            diff.moved.push_back(runner_id);
+        }
+        if (!same_runner(loaded->second, entry.second)) {
+            loaded->second = entry.second;
+            diff.edited.push_back(runner_id);
+        }
+    }
+
+    for (auto team = teams.begin(); team != teams.end(); ) {
+        auto members = rosters.team_to_runners.find(team->first);
+        if (members != rosters.team_to_runners.end() && !members->second.empty()) {
+            ++team;
+            continue;
+        }
+        if (members != rosters.team_to_runners.end()) {
+            rosters.team_to_runners.erase(members);
+        }
+        diff.removed_teams.push_back(team->first);
+        diff.affected_teams.insert(team->first);
+        team = teams.erase(team);
+    }
+    return true;
+}
+
+bool rescores(const RosterDiff &diff, const std::vector<RunnerId> &barcodes) {
+    if (!diff.added_teams.empty() || !diff.removed_teams.empty()) {
+        return true;
+    }
+    std::vector<RunnerId> changed;
+    changed.insert(changed.end(), diff.added.begin(), diff.added.end());
+    changed.insert(changed.end(), diff.removed.begin(), diff.removed.end());
+    changed.insert(changed.end(), diff.moved.begin(), diff.moved.end());
+    if (changed.empty()) {
+        return false;
+    }
+    std::sort(changed.begin(), changed.end());
+    for (auto runner_id : barcodes) {
+        if (std::binary_search(changed.begin(), changed.end(), runner_id)) {
+            return true;
+        }
+    }
+    return false;
+}
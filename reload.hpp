@@ -0,0 +1,39 @@
+#ifndef RELOAD_HPP
+#define RELOAD_HPP
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// What a roster reload changed. Runners keep their bib and teams keep
+// their id; a team new to the file gets an id past every team so far,
+// including teams that have since emptied, so an old id is never reused.
+struct RosterDiff {
+    std::vector<RunnerId> added;
+    std::vector<RunnerId> removed;
+    std::vector<RunnerId> moved;  // to another team
+    std::vector<RunnerId> edited; // name, grade or gender
+    std::vector<TeamId> added_teams;
+    std::vector<TeamId> removed_teams; // no runners left
+    std::vector<TeamId> edited_teams;  // name or location
+    std::set<TeamId> affected_teams;   // gained or lost a runner
+};
+
+std::ostream &operator<<(std::ostream &os, const RosterDiff &diff);
+
+bool empty(const RosterDiff &diff);
+
+// Reads roster_file and brings the loaded roster in line with it,
+// touching only the runners and teams that differ.
+bool reload_roster(const std::string &roster_file, Rosters &rosters, Teams &teams, Runners &runners, RosterDiff &diff);
+
+// Whether a race with these barcodes scores differently after the diff:
+// one of its finishers came, went or changed team, or a team came or
+// went, which adds or drops a row in every race's results. Barcodes
+// rather than finishes, since a late entry's finish was left out until
+// now. Edits only change how the race's report reads.
+bool rescores(const RosterDiff &diff, const std::vector<RunnerId> &barcodes);
+
+#endif
@@ -0,0 +1,289 @@
+#include <aio.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include "report.hpp"
+
+static bool same_finish(const Finish &a, const Finish &b) {
+    return a.runner_id == b.runner_id &&
+        a.time.get_total_seconds() == b.time.get_total_seconds() &&
+        a.score == b.score;
+}
+
+static bool same_result(const Result &a, const Result &b) {
+    if (a.place != b.place || a.team_id != b.team_id ||
+        a.squad.score != b.squad.score ||
+        a.squad.time.get_total_seconds() != b.squad.time.get_total_seconds() ||
+        a.squad.places.size() != b.squad.places.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.squad.places.size(); i++) {
+        if (a.squad.places[i].runner_id != b.squad.places[i].runner_id ||
+            a.squad.places[i].place_number != b.squad.places[i].place_number) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Rules>
+ReportCache<Rules>::ReportCache()
+: rendered_rows(0)
+{
+    std::stringstream ss;
+    output_individuals_header(ss);
+    individuals_header = ss.str();
+    ss.str("");
+    output_team_scores_header(ss);
+    team_scores_header = ss.str();
+    ss.str("");
+    output_results_footer(ss);
+    footer = ss.str();
+}
+
+template <typename Rules>
+const std::string &ReportCache<Rules>::render(std::size_t race_number,
+        const Rosters &rosters, const Teams &teams, const Runners &runners, const Finishes &finishes, const Results &results) {
+    rendered_rows = 0;
+    if (races.size() <= race_number) {
+        races.resize(race_number + 1);
+    }
+    auto &race = races[race_number];
+
+    const auto old_individuals = race.finishes.size();
+    const auto individuals = finishes.size();
+    // same row count in both sections: changed rows of the same width can
+    // be written straight over the old ones
+    bool in_place = !race.text.empty() && old_individuals == individuals && race.results.size() == results.size();
+
+    std::vector<std::string> rows(individuals + results.size());
+    std::vector<std::size_t> changed;
+    std::stringstream ss;
+    for (std::size_t i = 0; i < individuals; i++) {
+        if (i < old_individuals && same_finish(finishes[i], race.finishes[i])) {
+            rows[i] = std::move(race.rows[i]);
+            continue;
+        }
+        ss.str("");
+        output_individual(ss, i + 1, rosters, teams, runners, finishes[i]);
+        rows[i] = ss.str();
+        in_place = in_place && rows[i].size() == race.rows[i].size();
+        changed.push_back(i);
+    }
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const auto old = old_individuals + i;
+        if (i < race.results.size() && same_result(results[i], race.results[i])) {
+            rows[individuals + i] = std::move(race.rows[old]);
+            continue;
+        }
+        ss.str("");
+        output_team_score<Rules>(ss, teams, results[i]);
+        rows[individuals + i] = ss.str();
+        in_place = in_place && rows[individuals + i].size() == race.rows[old].size();
+        changed.push_back(individuals + i);
+    }
+    rendered_rows = changed.size();
+
+    if (in_place) {
+        for (auto row : changed) {
+            race.text.replace(race.offsets[row], rows[row].size(), rows[row]);
+        }
+    } else {
+        race.text.clear();
+        race.offsets.resize(rows.size());
+        race.text += individuals_header;
+        for (std::size_t row = 0; row < rows.size(); row++) {
+            if (row == individuals) {
+                race.text += team_scores_header;
+            }
+            race.offsets[row] = race.text.size();
+            race.text += rows[row];
+        }
+        if (rows.size() == individuals) {
+            race.text += team_scores_header;
+        }
+        race.text += footer;
+    }
+
+    race.rows = std::move(rows);
+    race.finishes = finishes;
+    race.results = results;
+    return race.text;
+}
+
+template <typename Rules>
+void ReportCache<Rules>::output(std::ostream &os, const Wildcat &w) {
+    std::size_t rows = 0;
+    switch (w.heat.tag) {
+    case Heat::Tag::Single:
+        os << render(0, w.rosters, w.teams, w.runners, *w.heat.single.finishes, *w.heat.single.results);
+        rows = rendered_rows;
+        break;
+    case Heat::Tag::Combined:
+        os << render(0, w.rosters, w.teams, w.runners, *w.heat.combined.varsity_finishes, *w.heat.combined.varsity_results);
+        rows = rendered_rows;
+        os << '\n';
+        os << render(1, w.rosters, w.teams, w.runners, *w.heat.combined.jv_finishes, *w.heat.combined.jv_results);
+        rows += rendered_rows;
+        break;
+    }
+    output_signature(os);
+    rendered_rows = rows;
+}
+
+template <typename Rules>
+void ReportCache<Rules>::invalidate() {
+    races.clear();
+}
+
+template <typename Rules>
+std::size_t ReportCache<Rules>::get_rendered_rows() const {
+    return rendered_rows;
+}
+
+std::ostream &operator<<(std::ostream &os, const BatchStats &stats) {
+    os << stats.files << " reports, " << stats.bytes << " bytes in " << stats.wall_seconds << " s";
+    os << " (formatting " << stats.render_seconds << " s)";
+    return os;
+}
+
+void add_report_jobs(const Wildcat &w, const std::string &prefix, std::vector<ReportJob> &jobs) {
+    switch (w.heat.tag) {
+    case Heat::Tag::Single:
+        jobs.push_back({ prefix + ".txt", &w.rosters, &w.teams, &w.runners,
+            w.heat.single.finishes, w.heat.single.results });
+        break;
+    case Heat::Tag::Combined:
+        jobs.push_back({ prefix + "_varsity.txt", &w.rosters, &w.teams, &w.runners,
+            w.heat.combined.varsity_finishes, w.heat.combined.varsity_results });
+        jobs.push_back({ prefix + "_jv.txt", &w.rosters, &w.teams, &w.runners,
+            w.heat.combined.jv_finishes, w.heat.combined.jv_results });
+        break;
+    }
+}
+
+template <typename Rules>
+bool write_reports(const std::vector<ReportJob> &jobs, BatchStats &stats) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    stats = BatchStats();
+
+    const auto n = jobs.size();
+    std::vector<std::string> buffers(n);
+    std::mutex mutex;
+    std::condition_variable rendered;
+    std::vector<std::size_t> ready;
+    std::size_t next = 0;
+
+    auto render = [&] () {
+        std::stringstream ss;
+        for (;;) {
+            std::size_t i;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (next == n) {
+                    return;
+                }
+                i = next++;
+            }
+            ss.str("");
+            const auto &job = jobs[i];
+            output_results<Rules>(ss, *job.rosters, *job.teams, *job.runners, *job.finishes, *job.results);
+            buffers[i] = ss.str();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.push_back(i);
+            }
+            rendered.notify_one();
+        }
+    };
+
+    const auto workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned int worker = 0; worker < workers; worker++) {
+        threads.emplace_back(render);
+    }
+
+    // this thread only opens files and queues writes; the kernel (or
+    // glibc's AIO threads) does the copying while rendering goes on
+    bool ok = true;
+    std::vector<aiocb> requests(n);
+    std::vector<int> fds(n, -1);
+    std::vector<aiocb *> batch;
+    std::vector<std::size_t> taken;
+    std::size_t submitted = 0;
+    while (submitted < n) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rendered.wait(lock, [&] { return !ready.empty(); });
+            taken.swap(ready);
+        }
+        batch.clear();
+        for (auto i : taken) {
+            submitted++;
+            fds[i] = ::open(jobs[i].file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fds[i] < 0) {
+                std::cerr << "write_reports(): Can't open \"" << jobs[i].file << "\"\n";
+                ok = false;
+                continue;
+            }
+            auto &request = requests[i];
+            std::memset(&request, 0, sizeof request);
+            request.aio_fildes = fds[i];
+            request.aio_buf = const_cast<char *>(buffers[i].data());
+            request.aio_nbytes = buffers[i].size();
+            request.aio_offset = 0;
+            request.aio_lio_opcode = LIO_WRITE;
+            request.aio_sigevent.sigev_notify = SIGEV_NONE;
+            batch.push_back(&request);
+        }
+        taken.clear();
+        if (!batch.empty() && lio_listio(LIO_NOWAIT, batch.data(), batch.size(), nullptr) != 0 && errno != EIO) {
+            // EIO means some requests failed; those show up below
+            std::cerr << "write_reports(): lio_listio(): " << std::strerror(errno) << "\n";
+            ok = false;
+        }
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    stats.render_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (std::size_t i = 0; i < n; i++) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        const aiocb *request = &requests[i];
+        int error;
+        while ((error = aio_error(request)) == EINPROGRESS) {
+            aio_suspend(&request, 1, nullptr);
+        }
+        const auto written = aio_return(&requests[i]);
+        if (error != 0 || written != static_cast<ssize_t>(buffers[i].size())) {
+            std::cerr << "write_reports(): Can't write \"" << jobs[i].file << "\"\n";
+            ok = false;
+        } else {
+            stats.files++;
+            stats.bytes += written;
+        }
+        ::close(fds[i]);
+    }
+
+    stats.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return ok;
+}
+
+template class ReportCache<Nfhs>;
+template class ReportCache<FourScorer>;
+template class ReportCache<SixDisplacer>;
+
+template bool write_reports<Nfhs>(const std::vector<ReportJob> &jobs, BatchStats &stats);
+template bool write_reports<FourScorer>(const std::vector<ReportJob> &jobs, BatchStats &stats);
+template bool write_reports<SixDisplacer>(const std::vector<ReportJob> &jobs, BatchStats &stats);
@@ -0,0 +1,77 @@
+#ifndef REPORT_HPP
+#define REPORT_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// Keeps every race's rendered report, row by row. A finish or result that
+// is the same as last time keeps its rendered row; only the rows that
+// changed are formatted again and spliced into the cached text, so
+// reprinting after a correction costs about a copy of the report.
+template <typename Rules = Nfhs>
+class ReportCache {
+public:
+    ReportCache();
+
+    // The same text as output_results() for race number `race`.
+    const std::string &render(std::size_t race,
+        const Rosters &rosters, const Teams &teams, const Runners &runners, const Finishes &finishes, const Results &results);
+
+    // The same text as operator<<(std::ostream &, const Wildcat &).
+    void output(std::ostream &os, const Wildcat &w);
+
+    // Rows only notice their own finish or result changing. Call this
+    // after the roster changes (a name, grade or team's initials).
+    void invalidate();
+
+    // rows formatted by the last render() or output()
+    std::size_t get_rendered_rows() const;
+
+private:
+    struct Race {
+        Finishes finishes;
+        Results results;
+        std::vector<std::string> rows; // individuals, then team scores
+        std::vector<std::size_t> offsets; // where each row starts in text
+        std::string text;
+    };
+
+    std::string individuals_header;
+    std::string team_scores_header;
+    std::string footer;
+    std::vector<Race> races;
+    std::size_t rendered_rows;
+};
+
+// One report file of a batch. The pointers must outlive write_reports().
+struct ReportJob {
+    std::string file;
+    const Rosters *rosters;
+    const Teams *teams;
+    const Runners *runners;
+    const Finishes *finishes;
+    const Results *results;
+};
+
+struct BatchStats {
+    std::size_t files = 0;
+    std::size_t bytes = 0;
+    double render_seconds = 0; // until the last report was formatted
+    double wall_seconds = 0;   // until the last byte was on its way to disk
+};
+
+std::ostream &operator<<(std::ostream &os, const BatchStats &stats);
+
+// Adds a job per race of the heat: <prefix>.txt for a single race,
+// <prefix>_varsity.txt and <prefix>_jv.txt for a combined one.
+void add_report_jobs(const Wildcat &w, const std::string &prefix, std::vector<ReportJob> &jobs);
+
+// Formats every job's report on all cores and writes each into its own
+// file with POSIX AIO, submitted in batches as reports come off the
+// renderers, so formatting and writing overlap.
+template <typename Rules = Nfhs>
+bool write_reports(const std::vector<ReportJob> &jobs, BatchStats &stats);
+
+#endif
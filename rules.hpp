@@ -0,0 +1,50 @@
+#ifndef RULES_HPP
+#define RULES_HPP
+
+// Team scoring formats as compile-time policies. Scoring code is written
+// once as a template over the rules and instantiated per format, so every
+// count below is a constant inside the loops that use it.
+
+// Squad positions (1-based) compared in order when team scores tie. Every
+// position but the last only decides if both squads have a runner there
+// and they differ; the last one is the final word.
+//
+// Place numbers are unique, so the first listed position both squads have
+// always decides. Under Nfhs a 7th runner therefore never breaks a tie: two
+// squads that both have a 7th also both have a 6th. For example, A placing
+// 1 4 6 8 11 15 16 17 and B placing 2 3 5 7 13 14 18 tie on 30; the 6th
+// runners (15 against 14) give it to B before the 7th is looked at. Earlier
+// code only compared 7th runners when both squads had exactly seven
+// finishers; that never changed a result and this doesn't either.
+template <unsigned int... Positions>
+struct TieBreak {};
+
+template <unsigned int Scorers, unsigned int Displacers, typename TieBreaks, unsigned int MinimumSquad = Scorers>
+struct ScoringRules {
+    static const unsigned int scorers = Scorers;
+    static const unsigned int displacers = Displacers;
+    static const unsigned int minimum_squad = MinimumSquad;
+    using tie_breaks = TieBreaks;
+
+    static_assert(Scorers > 0, "a team needs at least one scorer");
+    static_assert(Displacers >= Scorers, "every scorer also displaces");
+    static_assert(MinimumSquad >= Scorers, "a squad can't score without its scorers");
+};
+
+template <unsigned int Scorers, unsigned int Displacers, typename TieBreaks, unsigned int MinimumSquad>
+const unsigned int ScoringRules<Scorers, Displacers, TieBreaks, MinimumSquad>::scorers;
+template <unsigned int Scorers, unsigned int Displacers, typename TieBreaks, unsigned int MinimumSquad>
+const unsigned int ScoringRules<Scorers, Displacers, TieBreaks, MinimumSquad>::displacers;
+template <unsigned int Scorers, unsigned int Displacers, typename TieBreaks, unsigned int MinimumSquad>
+const unsigned int ScoringRules<Scorers, Displacers, TieBreaks, MinimumSquad>::minimum_squad;
+
+// 5 score, 6th and 7th displace; ties go 6th, 7th, then 5th runner.
+using Nfhs = ScoringRules<5, 7, TieBreak<6, 7, 5>>;
+
+// 4 score, 5th and 6th displace.
+using FourScorer = ScoringRules<4, 6, TieBreak<5, 6, 4>>;
+
+// 5 score, only the 6th displaces.
+using SixDisplacer = ScoringRules<5, 6, TieBreak<6, 5>>;
+
+#endif
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include "search.hpp"
+
+static void split_words(const std::string &text, std::vector<std::string> &words) {
+    words.clear();
+    std::string word;
+    for (auto c : text) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            word.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(word);
+    }
+}
+
+static bool is_word(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+// whether some word of a lowercased name starts with prefix
+static bool has_word_prefix(const char *name, const std::string &prefix) {
+    for (auto *c = name; *c; c++) {
+        if (is_word(*c) && (c == name || !is_word(c[-1])) &&
+            std::strncmp(c, prefix.c_str(), prefix.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool all_digits(const std::string &s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [] (char c) {
+        return std::isdigit(static_cast<unsigned char>(c));
+    });
+}
+
+// a and b differ by at most one insertion, deletion, substitution or
+// swap of neighbours
+static bool within_one_edit(const char *a, std::size_t a_length, const char *b, std::size_t b_length) {
+    if (a_length > b_length) {
+        std::swap(a, b);
+        std::swap(a_length, b_length);
+    }
+    if (b_length - a_length > 1) {
+        return false;
+    }
+    std::size_t i = 0;
+    while (i < a_length && a[i] == b[i]) {
+        i++;
+    }
+    if (i == a_length) {
+        return true;
+    }
+    if (a_length == b_length) {
+        return std::equal(a + i + 1, a + a_length, b + i + 1) ||
+            (i + 1 < a_length && a[i] == b[i + 1] && a[i + 1] == b[i] &&
+             std::equal(a + i + 2, a + a_length, b + i + 2));
+    }
+    return std::equal(a + i, a + a_length, b + i + 1);
+}
+
+void build_search_index(const Runners &runners, const Rosters &rosters, const Teams &teams, SearchIndex &index) {
+    index.pool.clear();
+    index.words.clear();
+    index.teams.clear();
+    index.runners = &runners;
+    index.rosters = &rosters;
+
+    std::vector<std::string> words;
+    for (auto &runner : runners) {
+        const auto name = static_cast<std::uint32_t>(index.pool.size());
+        for (auto c : runner.second.name) {
+            index.pool.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+        index.pool.push_back('\0');
+
+        split_words(runner.second.name, words);
+        for (auto &word : words) {
+            const auto length = std::min<std::size_t>(word.size(), 255);
+            index.words.push_back({
+                static_cast<std::uint32_t>(index.pool.size()),
+                static_cast<std::uint8_t>(length),
+                runner.first,
+                name,
+            });
+            index.pool.append(word, 0, length);
+        }
+    }
+
+    const auto *pool = index.pool.data();
+    std::sort(index.words.begin(), index.words.end(), [pool] (const SearchIndex::Word &a, const SearchIndex::Word &b) {
+        const auto c = std::memcmp(pool + a.offset, pool + b.offset, std::min(a.length, b.length));
+        if (c != 0) {
+            return c < 0;
+        }
+        if (a.length != b.length) {
+            return a.length < b.length;
+        }
+        return a.runner_id < b.runner_id;
+    });
+
+    for (auto &team : teams) {
+        std::string initials;
+        for (auto c : team.second.initials) {
+            initials.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+        index.teams[initials] = team.first;
+    }
+}
+
+void search_runners(const SearchIndex &index, const std::string &query, std::size_t limit, std::vector<RunnerId> &matches) {
+    matches.clear();
+    if (!index.runners || !index.rosters) {
+        return;
+    }
+
+    std::vector<std::string> tokens;
+    split_words(query, tokens);
+
+    std::vector<std::string> names;
+    std::set<TeamId> team_filter;
+    for (auto &token : tokens) {
+        if (all_digits(token)) {
+            int bib;
+            if (std::sscanf(token.c_str(), "%d", &bib) == 1 && index.runners->count(bib) && matches.size() < limit) {
+                matches.push_back(bib);
+            }
+            continue;
+        }
+        auto team = index.teams.find(token);
+        if (team != index.teams.end()) {
+            team_filter.insert(team->second);
+            continue;
+        }
+        names.push_back(token);
+    }
+
+    auto on_team = [&] (RunnerId runner_id) {
+        if (team_filter.empty()) {
+            return true;
+        }
+        auto team = index.rosters->runner_to_team.find(runner_id);
+        return team != index.rosters->runner_to_team.end() && team_filter.count(team->second);
+    };
+
+    if (names.empty()) {
+        for (auto team_id : team_filter) {
+            auto runners = index.rosters->team_to_runners.find(team_id);
+            if (runners == index.rosters->team_to_runners.end()) {
+                continue;
+            }
+            for (auto runner_id : runners->second) {
+                if (matches.size() == limit) {
+                    return;
+                }
+                matches.push_back(runner_id);
+            }
+        }
+        return;
+    }
+
+    const auto *pool = index.pool.data();
+    auto prefix_of = [&] (const SearchIndex::Word &word, const std::string &prefix) {
+        const auto n = std::min<std::size_t>(word.length, prefix.size());
+        const auto c = std::memcmp(pool + word.offset, prefix.data(), n);
+        if (c != 0) {
+            return c;
+        }
+        return word.length < prefix.size() ? -1 : 0;
+    };
+    using WordRange = std::pair<std::vector<SearchIndex::Word>::const_iterator,
+                                std::vector<SearchIndex::Word>::const_iterator>;
+    auto prefix_range = [&] (const std::string &prefix) {
+        auto first = std::lower_bound(index.words.begin(), index.words.end(), prefix,
+            [&] (const SearchIndex::Word &word, const std::string &p) {
+                return prefix_of(word, p) < 0;
+            });
+        auto last = std::upper_bound(first, index.words.end(), prefix,
+            [&] (const std::string &p, const SearchIndex::Word &word) {
+                return prefix_of(word, p) > 0;
+            });
+        return WordRange(first, last);
+    };
+
+    // walk the narrowest range; every other word must prefix some other
+    // part of the same name
+    std::vector<WordRange> ranges;
+    for (auto &name : names) {
+        ranges.push_back(prefix_range(name));
+    }
+    auto span = [] (const WordRange &range) {
+        return range.second - range.first;
+    };
+    std::size_t primary = 0;
+    for (std::size_t i = 1; i < names.size(); i++) {
+        if (span(ranges[i]) < span(ranges[primary])) {
+            primary = i;
+        }
+    }
+
+    auto matches_rest = [&] (const char *name) {
+        for (std::size_t i = 0; i < names.size(); i++) {
+            if (i != primary && !has_word_prefix(name, names[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::set<RunnerId> seen;
+    auto consider = [&] (const SearchIndex::Word &word) {
+        if (matches.size() < limit && matches_rest(pool + word.name) && on_team(word.runner_id) &&
+            seen.insert(word.runner_id).second) {
+            matches.push_back(word.runner_id);
+        }
+    };
+
+    // a team is often a shorter walk than a common name
+    std::size_t team_size = 0;
+    for (auto team_id : team_filter) {
+        auto runners = index.rosters->team_to_runners.find(team_id);
+        if (runners != index.rosters->team_to_runners.end()) {
+            team_size += runners->second.size();
+        }
+    }
+    if (!team_filter.empty() && team_size < static_cast<std::size_t>(span(ranges[primary]))) {
+        for (auto team_id : team_filter) {
+            auto runners = index.rosters->team_to_runners.find(team_id);
+            if (runners == index.rosters->team_to_runners.end()) {
+                continue;
+            }
+            std::string name;
+            for (auto runner_id : runners->second) {
+                name.clear();
+                for (auto c : index.runners->find(runner_id)->second.name) {
+                    name.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+                }
+                if (has_word_prefix(name.c_str(), names[primary]) && matches_rest(name.c_str()) &&
+                    seen.insert(runner_id).second) {
+                    matches.push_back(runner_id);
+                }
+                if (matches.size() == limit) {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
+    for (auto word = ranges[primary].first; word != ranges[primary].second; ++word) {
+        consider(*word);
+        if (matches.size() == limit) {
+            return;
+        }
+    }
+
+    // nothing by prefix: allow one typo in a word that matched nothing,
+    // past its first two letters so the scan stays short
+    if (!matches.empty() || span(ranges[primary]) != 0) {
+        return;
+    }
+    const auto &typo = names[primary];
+    const auto n = typo.size();
+    if (n < 4) {
+        return;
+    }
+    const auto range = prefix_range(typo.substr(0, 2));
+    for (auto word = range.first; word != range.second; ++word) {
+        const auto *text = pool + word->offset;
+        const bool close =
+            (word->length >= n - 1 && within_one_edit(text, n - 1, typo.data(), n)) ||
+            (word->length >= n && within_one_edit(text, n, typo.data(), n)) ||
+            (word->length >= n + 1 && within_one_edit(text, n + 1, typo.data(), n));
+        if (close) {
+            consider(*word);
+            if (matches.size() == limit) {
+                return;
+            }
+        }
+    }
+}
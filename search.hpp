@@ -0,0 +1,34 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// Every word of every runner's name, lowercased and sorted. The words and
+// the whole lowercased names are packed into one string pool, so a prefix
+// is a binary search and checking the rest of a name never leaves it.
+struct SearchIndex {
+    struct Word {
+        std::uint32_t offset;
+        std::uint8_t length;
+        RunnerId runner_id;
+        std::uint32_t name; // nul terminated
+    };
+
+    std::string pool;
+    std::vector<Word> words;
+    std::map<std::string, TeamId> teams; // lowercased initials
+    const Runners *runners = nullptr;
+    const Rosters *rosters = nullptr;
+};
+
+void build_search_index(const Runners &runners, const Rosters &rosters, const Teams &teams, SearchIndex &index);
+
+// Words in the query may be a bib, a team's initials or the start of any
+// part of the name, e.g. "smi hhs" or "1234". When no name matches a
+// prefix, names one typo away are tried instead.
+void search_runners(const SearchIndex &index, const std::string &query, std::size_t limit, std::vector<RunnerId> &matches);
+
+#endif
@@ -0,0 +1,224 @@
+#include <queue>
+#include "season.hpp"
+
+static unsigned int class_bucket(const optional<Class> &klass) {
+    return klass ? static_cast<unsigned int>(*klass) : Season::class_buckets - 1;
+}
+
+static unsigned int gender_bucket(const optional<Gender> &gender) {
+    return gender ? static_cast<unsigned int>(*gender) : Season::gender_buckets - 1;
+}
+
+float SeasonTeam::average_score() const {
+    if (races == 0) {
+        return 0;
+    }
+    return static_cast<float>(total_score) / races;
+}
+
+static void add_finish(Season &season, const Runner &runner, const std::string &team, RunnerId runner_id, float time) {
+    auto &entry = season.runners[runner_id];
+
+    if (entry.best > 0) {
+        season.bests[class_bucket(entry.runner.klass)][gender_bucket(entry.runner.gender)]
+            .erase(std::make_pair(entry.best, runner_id));
+    }
+
+    entry.runner = runner;
+    entry.team = team;
+    entry.races++;
+    if (entry.best == 0 || time < entry.best) {
+        entry.best = time;
+    }
+
+    season.bests[class_bucket(entry.runner.klass)][gender_bucket(entry.runner.gender)]
+        .insert(std::make_pair(entry.best, runner_id));
+    season.performances++;
+}
+
+static void add_team_score(Season &season, const std::string &initials, unsigned int score) {
+    auto &team = season.teams[initials];
+    team.initials = initials;
+
+    if (team.races > 0) {
+        season.team_rankings.erase(std::make_pair(team.average_score(), initials));
+    }
+
+    team.races++;
+    team.total_score += score;
+
+    season.team_rankings.insert(std::make_pair(team.average_score(), initials));
+}
+
+void add_race(Season &season,
+        const Runners &runners, const Rosters &rosters, const Teams &teams,
+        const Finishes &finishes, const Results &results, bool team_scores) {
+
+    for (auto &finish : finishes) {
+        const auto runner = runners.find(finish.runner_id);
+        const auto team_id = rosters.runner_to_team.find(finish.runner_id);
+        if (runner == runners.end() || team_id == rosters.runner_to_team.end()) {
+            continue;
+        }
+        const auto team = teams.find(team_id->second);
+        add_finish(season, runner->second, team == teams.end() ? std::string() : team->second.initials,
+            finish.runner_id, finish.time.get_total_seconds());
+    }
+
+    if (!team_scores) {
+        return;
+    }
+
+    for (auto &result : results) {
+        const auto team = teams.find(result.team_id);
+        if (result.squad.score == 0 || team == teams.end()) {
+            continue;
+        }
+        add_team_score(season, team->second.initials, result.squad.score);
+    }
+}
+
+void add_meet(Season &season, const Wildcat &w) {
+    switch (w.heat.tag) {
+    case Heat::Tag::Single:
+        add_race(season, w.runners, w.rosters, w.teams,
+            *w.heat.single.finishes, *w.heat.single.results, true);
+        break;
+    case Heat::Tag::Combined:
+        // only varsity scores count toward a team's season average
+        add_race(season, w.runners, w.rosters, w.teams,
+            *w.heat.combined.varsity_finishes, *w.heat.combined.varsity_results, true);
+        add_race(season, w.runners, w.rosters, w.teams,
+            *w.heat.combined.jv_finishes, *w.heat.combined.jv_results, false);
+        break;
+    }
+    season.meets++;
+}
+
+bool add_archive(Season &season, const Archive &archive) {
+    static const std::string jv = " JV";
+    Finishes finishes;
+    Results results;
+    for (std::size_t i = 0; i < archive.races.size(); i++) {
+        if (!read_race(archive, i, finishes, results)) {
+            return false;
+        }
+        const auto &label = archive.races[i].label;
+        const bool is_jv = label.size() >= jv.size() && label.compare(label.size() - jv.size(), jv.size(), jv) == 0;
+        add_race(season, archive.runners, archive.rosters, archive.teams, finishes, results, !is_jv);
+        // a combined heat's JV race is the same meet as its varsity race
+        if (!is_jv) {
+            season.meets++;
+        }
+    }
+    return true;
+}
+
+void top_runners(const Season &season, std::size_t n,
+        optional<Class> klass, optional<Gender> gender, std::vector<RunnerId> &top) {
+
+    top.clear();
+
+    using Cursor = std::pair<std::set<std::pair<float, RunnerId>>::const_iterator,
+        std::set<std::pair<float, RunnerId>>::const_iterator>;
+    auto later = [] (const Cursor &a, const Cursor &b) {
+        return *b.first < *a.first;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> queue(later);
+
+    // merge the sorted buckets that match the filter, stopping after n
+    for (unsigned int c = 0; c < Season::class_buckets; c++) {
+        if (klass && c != class_bucket(klass)) {
+            continue;
+        }
+        for (unsigned int g = 0; g < Season::gender_buckets; g++) {
+            if (gender && g != gender_bucket(gender)) {
+                continue;
+            }
+            const auto &bucket = season.bests[c][g];
+            if (!bucket.empty()) {
+                queue.push(Cursor(bucket.begin(), bucket.end()));
+            }
+        }
+    }
+
+    while (top.size() < n && !queue.empty()) {
+        auto cursor = queue.top();
+        queue.pop();
+        top.push_back(cursor.first->second);
+        if (++cursor.first != cursor.second) {
+            queue.push(cursor);
+        }
+    }
+}
+
+void top_teams(const Season &season, std::size_t n, std::vector<std::string> &top) {
+    top.clear();
+    for (auto &ranking : season.team_rankings) {
+        if (top.size() == n) {
+            break;
+        }
+        top.push_back(ranking.second);
+    }
+}
+
+void output_season(std::ostream &os, const Season &season, std::size_t n) {
+    std::stringstream ss;
+    auto extend = [&] (std::size_t limit) {
+        for (auto j = ss.str().length(); j < limit; j++) {
+            ss << ' ';
+        }
+    };
+    auto flush = [&] {
+        os << ss.str() << '\n';
+        ss.str("");
+    };
+
+    os << "SEASON (" << season.meets << " meets, " << season.performances << " performances)\n";
+    os << "==================================================================================\n";
+    os << '\n';
+    os << "Rank   Team      Races    Average\n";
+    os << "----------------------------------------------------------------------------------\n";
+    std::vector<std::string> teams;
+    top_teams(season, n, teams);
+    for (std::size_t i = 0; i < teams.size(); i++) {
+        const auto &team = season.teams.find(teams[i])->second;
+        ss << i + 1;
+        extend(7);
+        ss << team.initials;
+        extend(17);
+        ss << team.races;
+        extend(26);
+        ss << static_cast<int>(team.average_score() * 10 + 0.5f) / 10.0f;
+        flush();
+    }
+
+    const std::pair<Gender, const char *> genders[] = { { Gender::F, "Girls" }, { Gender::M, "Boys" } };
+    std::vector<RunnerId> top;
+    for (auto &gender : genders) {
+        os << '\n';
+        os << gender.second << '\n';
+        os << "Rank   Name                     Team      Class    Best        Races\n";
+        os << "----------------------------------------------------------------------------------\n";
+        top_runners(season, n, optional<Class>(), gender.first, top);
+        for (std::size_t i = 0; i < top.size(); i++) {
+            const auto &runner = season.runners.find(top[i])->second;
+            ss << i + 1;
+            extend(7);
+            ss << runner.runner.name;
+            extend(32);
+            ss << runner.team;
+            extend(42);
+            if (runner.runner.klass) {
+                ss << *runner.runner.klass;
+            }
+            extend(51);
+            ss << Time(runner.best);
+            extend(63);
+            ss << runner.races;
+            flush();
+        }
+    }
+
+    os << "==================================================================================\n";
+}
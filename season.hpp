@@ -0,0 +1,59 @@
+#ifndef SEASON_HPP
+#define SEASON_HPP
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "archive.hpp"
+#include "wildcat.hpp"
+
+// Runner and team ids are only stable within one roster import, so the
+// season keys runners by RunnerId (the state bib) and teams by initials.
+
+struct SeasonRunner {
+    Runner runner;
+    std::string team;
+    float best = 0;
+    unsigned int races = 0;
+};
+
+struct SeasonTeam {
+    std::string initials;
+    unsigned int races = 0;
+    unsigned long total_score = 0;
+    float average_score() const;
+};
+
+// A meet's finishes are folded in as they arrive, keeping each index sorted
+// so that queries only walk as far as the answer they need.
+struct Season {
+    static const unsigned int class_buckets = 5; // Fr, So, Jr, Sr, none
+    static const unsigned int gender_buckets = 3; // F, M, none
+
+    std::map<RunnerId, SeasonRunner> runners;
+    std::map<std::string, SeasonTeam> teams;
+    std::set<std::pair<float, RunnerId>> bests[class_buckets][gender_buckets];
+    std::set<std::pair<float, std::string>> team_rankings;
+    unsigned int meets = 0;
+    unsigned long performances = 0;
+};
+
+void add_race(Season &season,
+    const Runners &runners, const Rosters &rosters, const Teams &teams,
+    const Finishes &finishes, const Results &results, bool team_scores);
+void add_meet(Season &season, const Wildcat &w);
+// Every race in an archive; JV races ("... JV") don't count toward team
+// averages, as in add_meet(). False if a race doesn't decode.
+bool add_archive(Season &season, const Archive &archive);
+
+void top_runners(const Season &season, std::size_t n,
+    optional<Class> klass, optional<Gender> gender, std::vector<RunnerId> &top);
+void top_teams(const Season &season, std::size_t n, std::vector<std::string> &top);
+
+// The top n teams by average score, then the top n girls and boys.
+void output_season(std::ostream &os, const Season &season, std::size_t n);
+
+#endif
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <dirent.h>
+#include <map>
+#include <memory>
+#include <sys/stat.h>
+#include <thread>
+#include "feed.hpp"
+#include "waves.hpp"
+#include "wildcat.hpp"
+
+// wildcat-server <input dir> <output dir> [--once]
+//
+// Headless batch scoring. Every subdirectory of the input directory is a
+// meet holding roster.txt, barcodes.txt and times.txt, as the GUI reads
+// them. A meet is scored whenever its files change (once they have sat
+// still for a second, so a copy in progress isn't picked up) and its
+// report goes to <output dir>/<meet>.txt. A meet with a waves.txt is
+// scored on net time. Meets are scored on all cores.
+// With --once every meet is scored a single time and the server exits,
+// for bulk rescoring and benchmarks. Each meet's standings are published
+// for scoreboards as the results feed /wildcat-<meet>; after --once they
+// stay posted.
+
+static const char *meet_files[] = { "roster.txt", "barcodes.txt", "times.txt" };
+
+// newest modification time of a meet's files, 0 if any is missing
+static long long meet_stamp(const std::string &meet_dir) {
+    long long newest = 0;
+    for (auto file : meet_files) {
+        struct stat st;
+        if (stat((meet_dir + '/' + file).c_str(), &st) != 0) {
+            return 0;
+        }
+        const auto stamp = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        newest = std::max(newest, stamp);
+    }
+    return newest;
+}
+
+static bool list_meets(const std::string &input_dir, std::vector<std::string> &meets) {
+    meets.clear();
+    auto dir = opendir(input_dir.c_str());
+    if (!dir) {
+        std::cerr << "wildcat-server: No directory \"" << input_dir << "\"\n";
+        return false;
+    }
+    while (auto entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        struct stat st;
+        if (stat((input_dir + '/' + entry->d_name).c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            meets.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(meets.begin(), meets.end());
+    return true;
+}
+
+static bool score_meet(const std::string &meet_dir, const std::string &report_file, FeedPublisher &feed) {
+    Wildcat w;
+    w.heat.set_combined();
+
+    if (!import_rosters_v2(meet_dir + "/roster.txt", w.rosters, w.teams, w.runners) ||
+        !import_barcodes_v2(meet_dir + "/barcodes.txt", w.barcodes) ||
+        !import_times_v2(meet_dir + "/times.txt", w.times)) {
+        return false;
+    }
+
+    make_finishes(w.times, w.barcodes, w.finishes);
+
+    const auto wave_file = meet_dir + "/waves.txt";
+    if (std::ifstream(wave_file)) {
+        Waves waves;
+        NetTimes net_times;
+        if (!import_waves(wave_file, w.teams, waves)) {
+            return false;
+        }
+        assign_waves(waves, w.rosters, w.times, w.barcodes, net_times);
+        net_finishes(net_times, w.finishes);
+    }
+
+    if (!score(w)) {
+        return false;
+    }
+    output_warnings(std::cerr, w);
+    feed.publish(w);
+
+    std::stringstream ss;
+    ss << w;
+    const auto report = ss.str();
+
+    std::ofstream file(report_file);
+    if (!file.is_open()) {
+        std::cerr << "wildcat-server: Can't open \"" << report_file << "\"\n";
+        return false;
+    }
+    file.write(report.data(), report.size());
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: wildcat-server <input dir> <output dir> [--once]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string input_dir = argv[1];
+    const std::string output_dir = argv[2];
+    const bool once = argc >= 4 && std::string(argv[3]) == "--once";
+
+    const auto workers = std::max(1u, std::thread::hardware_concurrency());
+    std::map<std::string, long long> scored; // meet -> stamp of the files it was scored from
+    std::map<std::string, std::unique_ptr<FeedPublisher>> feeds;
+
+    for (;;) {
+        std::vector<std::string> meets;
+        if (!list_meets(input_dir, meets)) {
+            return EXIT_FAILURE;
+        }
+
+        const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::vector<std::pair<std::string, long long>> pending;
+        for (auto &meet : meets) {
+            const auto stamp = meet_stamp(input_dir + '/' + meet);
+            const bool settled = once || now - stamp > 1000000000LL;
+            if (stamp && settled && scored[meet] != stamp) {
+                pending.push_back({ meet, stamp });
+            }
+        }
+
+        if (!pending.empty()) {
+            // opened here so the workers only ever touch their own meet's feed
+            for (auto &meet : pending) {
+                auto &feed = feeds[meet.first];
+                if (!feed) {
+                    feed.reset(new FeedPublisher);
+                    feed->open("/wildcat-" + meet.first);
+                }
+            }
+            const auto start = std::chrono::steady_clock::now();
+            std::atomic<std::size_t> next(0);
+            std::atomic<std::size_t> failed(0);
+            auto work = [&] () {
+                for (auto i = next++; i < pending.size(); i = next++) {
+                    const auto &meet = pending[i].first;
+                    if (!score_meet(input_dir + '/' + meet, output_dir + '/' + meet + ".txt", *feeds.at(meet))) {
+                        std::cerr << "wildcat-server: Can't score \"" << meet << "\"\n";
+                        failed++;
+                    }
+                }
+            };
+            std::vector<std::thread> threads;
+            for (unsigned int worker = 1; worker < workers; worker++) {
+                threads.emplace_back(work);
+            }
+            work();
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            // failed meets are retried only once their files change
+            for (auto &meet : pending) {
+                scored[meet.first] = meet.second;
+            }
+
+            const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << pending.size() - failed << " meet(s) scored, " << failed << " failed, in "
+                << seconds << " s on " << workers << " thread(s)" << std::endl;
+        }
+
+        if (once) {
+            for (auto &feed : feeds) {
+                feed.second->leave();
+            }
+            return EXIT_SUCCESS;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include "simulate.hpp"
+
+// xorshift128+: cheap enough that drawing the random times doesn't dwarf
+// the scoring it feeds.
+struct Rng {
+    std::uint64_t state[2];
+
+    Rng(std::uint64_t seed) {
+        state[0] = seed * 0x9E3779B97F4A7C15ull + 1;
+        state[1] = (seed ^ 0xD1B54A32D192ED03ull) * 0xBF58476D1CE4E5B9ull + 1;
+    }
+
+    std::uint64_t next() {
+        auto s1 = state[0];
+        const auto s0 = state[1];
+        state[0] = s0;
+        s1 ^= s1 << 23;
+        state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+        return state[1] + s0;
+    }
+
+    // (0, 1]
+    float uniform() {
+        return ((next() >> 40) + 1) * (1.0f / 16777216.0f);
+    }
+};
+
+// Marsaglia and Tsang's ziggurat: the normal curve cut into 128 strips of
+// equal area. Almost every draw lands inside its strip's rectangle and
+// costs one random number, a compare and a multiply; only the strip edges
+// and the tail need a log or exp.
+struct Ziggurat {
+    std::uint32_t k[128];
+    float w[128];
+    float f[128];
+
+    Ziggurat() {
+        const double m1 = 2147483648.0;
+        const double v = 9.91256303526217e-3;
+        double d = 3.442619855899;
+        double t = d;
+        const double q = v / std::exp(-0.5 * d * d);
+        k[0] = static_cast<std::uint32_t>((d / q) * m1);
+        k[1] = 0;
+        w[0] = static_cast<float>(q / m1);
+        w[127] = static_cast<float>(d / m1);
+        f[0] = 1.0f;
+        f[127] = static_cast<float>(std::exp(-0.5 * d * d));
+        for (int i = 126; i >= 1; i--) {
+            d = std::sqrt(-2.0 * std::log(v / d + std::exp(-0.5 * d * d)));
+            k[i + 1] = static_cast<std::uint32_t>((d / t) * m1);
+            t = d;
+            f[i] = static_cast<float>(std::exp(-0.5 * d * d));
+            w[i] = static_cast<float>(d / m1);
+        }
+    }
+};
+
+static const float ziggurat_tail = 3.442620f;
+
+// The strip comes from the random number's high bits and the value from
+// its low 32, so the two aren't correlated.
+static float draw_normal(Rng &rng, const Ziggurat &z) {
+    for (;;) {
+        const auto bits = rng.next();
+        const auto h = static_cast<std::int32_t>(static_cast<std::uint32_t>(bits));
+        const auto i = static_cast<unsigned int>(bits >> 57);
+        const auto x = h * z.w[i];
+        const auto magnitude = h < 0 ? 0u - static_cast<std::uint32_t>(h) : static_cast<std::uint32_t>(h);
+        if (magnitude < z.k[i]) {
+            return x;
+        }
+        if (i == 0) {
+            float tail;
+            float y;
+            do {
+                tail = -std::log(rng.uniform()) / ziggurat_tail;
+                y = -std::log(rng.uniform());
+            } while (y + y < tail * tail);
+            return h > 0 ? ziggurat_tail + tail : -ziggurat_tail - tail;
+        }
+        if (z.f[i] + rng.uniform() * (z.f[i - 1] - z.f[i]) < std::exp(-0.5f * x * x)) {
+            return x;
+        }
+    }
+}
+
+static void draw_normals(Rng &rng, float *z, std::size_t n) {
+    static const Ziggurat ziggurat;
+    for (std::size_t i = 0; i < n; i++) {
+        z[i] = draw_normal(rng, ziggurat);
+    }
+}
+
+static const std::uint32_t no_team = 0xFFFFFFFF;
+static const std::size_t batch_races = 32;
+// the unit of work a thread takes, and of the random streams
+static const unsigned long chunk_races = 4096;
+
+// Tie-breaks over a team's stored score numbers, 0 where it had no runner.
+template <typename TieBreaks>
+struct KernelTieBreaker;
+
+template <unsigned int Position, unsigned int... Rest>
+struct KernelTieBreaker<TieBreak<Position, Rest...>> {
+    static bool beats(const unsigned int *a, const unsigned int *b) {
+        if (a[Position - 1] && b[Position - 1] && a[Position - 1] != b[Position - 1]) {
+            return a[Position - 1] < b[Position - 1];
+        }
+        return KernelTieBreaker<TieBreak<Rest...>>::beats(a, b);
+    }
+};
+
+template <unsigned int Position>
+struct KernelTieBreaker<TieBreak<Position>> {
+    static bool beats(const unsigned int *a, const unsigned int *b) {
+        return a[Position - 1] < b[Position - 1];
+    }
+};
+
+// Flat per-race state for the scoring kernel. Score numbers stand in for
+// place numbers in tie-breaks; both rise together so comparisons agree.
+template <typename Rules>
+struct Kernel {
+    std::size_t runners;
+    std::size_t teams;
+    const float *mean;
+    const float *deviation;
+    const std::uint32_t *team;
+
+    std::vector<float> times;
+    std::vector<std::uint64_t> keys; // every race in the batch, back to back
+    std::vector<std::uint64_t> scratch;
+    std::vector<unsigned int> count;
+    std::vector<unsigned int> score;
+    std::vector<unsigned int> places; // every displacer's score number, per team
+    std::vector<std::uint32_t> order;
+
+    bool better(std::uint32_t a, std::uint32_t b) const {
+        if (score[a] != score[b]) {
+            return score[a] < score[b];
+        }
+        return KernelTieBreaker<typename Rules::tie_breaks>::beats(
+            &places[a * Rules::displacers], &places[b * Rules::displacers]);
+    }
+
+    void run(Rng &rng, unsigned long races, std::vector<unsigned long> &placements) {
+        times.resize(batch_races * runners);
+        keys.resize(batch_races * runners);
+        scratch.resize(runners);
+        count.resize(teams);
+        score.resize(teams);
+        places.resize(teams * Rules::displacers);
+        order.resize(teams);
+
+        while (races) {
+            const auto batch = std::min<unsigned long>(races, batch_races);
+            races -= batch;
+
+            // Perturb every runner of every race in the batch and turn the
+            // times into sort keys, in one flat pass. Non-negative floats
+            // order like their bit patterns, so the key is the time's bits
+            // with the runner index alongside. The bits every key in the
+            // batch shares tell which radix passes no race needs.
+            draw_normals(rng, times.data(), batch * runners);
+            std::uint32_t all_set = 0xFFFFFFFF;
+            std::uint32_t any_set = 0;
+            for (std::size_t b = 0; b < batch; b++) {
+                const auto *t = &times[b * runners];
+                auto *k = &keys[b * runners];
+                for (std::size_t r = 0; r < runners; r++) {
+                    const auto time = std::max(0.0f, mean[r] + deviation[r] * t[r]);
+                    std::uint32_t bits;
+                    std::memcpy(&bits, &time, sizeof bits);
+                    all_set &= bits;
+                    any_set |= bits;
+                    k[r] = (static_cast<std::uint64_t>(bits) << 32) | r;
+                }
+            }
+            const auto varying = all_set ^ any_set;
+
+            for (std::size_t b = 0; b < batch; b++) {
+                score_one(radix_sort(&keys[b * runners], varying), placements);
+            }
+        }
+    }
+
+    // LSD radix sort on the 32 time bits; a race is only a few hundred keys,
+    // where counting passes beat a comparison sort. Only the bytes that vary
+    // somewhere in the batch get a pass. Returns where the keys ended up.
+    const std::uint64_t *radix_sort(std::uint64_t *keys, std::uint32_t varying) {
+        unsigned int passes[4];
+        unsigned int pass_count = 0;
+        for (unsigned int pass = 0; pass < 4; pass++) {
+            if ((varying >> (8 * pass)) & 0xFF) {
+                passes[pass_count++] = pass;
+            }
+        }
+
+        unsigned int histogram[4][256] = {};
+        for (std::size_t r = 0; r < runners; r++) {
+            for (unsigned int p = 0; p < pass_count; p++) {
+                histogram[p][(keys[r] >> (32 + 8 * passes[p])) & 0xFF]++;
+            }
+        }
+        auto *from = keys;
+        auto *to = scratch.data();
+        for (unsigned int p = 0; p < pass_count; p++) {
+            const auto shift = 32 + 8 * passes[p];
+            auto &counts = histogram[p];
+            unsigned int offset = 0;
+            for (auto &c : counts) {
+                const auto next = offset + c;
+                c = offset;
+                offset = next;
+            }
+            for (std::size_t r = 0; r < runners; r++) {
+                to[counts[(from[r] >> shift) & 0xFF]++] = from[r];
+            }
+            std::swap(from, to);
+        }
+        return from;
+    }
+
+    void score_one(const std::uint64_t *sorted, std::vector<unsigned long> &placements) {
+        std::fill(count.begin(), count.end(), 0);
+        std::fill(score.begin(), score.end(), 0);
+        std::fill(places.begin(), places.end(), 0);
+
+        unsigned int score_num = 0;
+        for (std::size_t r = 0; r < runners; r++) {
+            const auto i = team[sorted[r] & 0xFFFFFFFF];
+            if (i == no_team) {
+                continue;
+            }
+            const auto c = count[i]++;
+            if (c >= Rules::displacers) {
+                continue;
+            }
+            score_num++;
+            if (c < Rules::scorers) {
+                score[i] += score_num;
+            }
+            places[i * Rules::displacers + c] = score_num;
+        }
+
+        for (std::uint32_t i = 0; i < teams; i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [this] (std::uint32_t a, std::uint32_t b) {
+            return better(a, b);
+        });
+        for (std::size_t place = 0; place < teams; place++) {
+            placements[order[place] * teams + place]++;
+        }
+    }
+};
+
+float Simulation::probability(std::size_t team, unsigned int place) const {
+    if (races == 0 || place == 0 || place > team_ids.size()) {
+        return 0;
+    }
+    return static_cast<float>(placements[team * team_ids.size() + place - 1]) / races;
+}
+
+float Simulation::top_probability(std::size_t team, unsigned int places) const {
+    float p = 0;
+    for (unsigned int place = 1; place <= places && place <= team_ids.size(); place++) {
+        p += probability(team, place);
+    }
+    return p;
+}
+
+template <typename Rules>
+void simulate(const Rosters &rosters, const Teams &teams, const std::vector<SeedTime> &seeds,
+        unsigned long races, unsigned int seed, Simulation &simulation, unsigned int threads) {
+
+    simulation.team_ids.clear();
+    simulation.placements.clear();
+    simulation.races = races;
+
+    std::map<TeamId, unsigned int> seeded;
+    for (auto &s : seeds) {
+        auto team_id = rosters.runner_to_team.find(s.runner_id);
+        if (team_id != rosters.runner_to_team.end()) {
+            seeded[team_id->second]++;
+        }
+    }
+
+    std::map<TeamId, std::uint32_t> index;
+    for (auto &team : teams) {
+        if (seeded[team.first] >= Rules::minimum_squad) {
+            index[team.first] = simulation.team_ids.size();
+            simulation.team_ids.push_back(team.first);
+        }
+    }
+
+    std::vector<float> mean;
+    std::vector<float> deviation;
+    std::vector<std::uint32_t> team;
+    for (auto &s : seeds) {
+        auto team_id = rosters.runner_to_team.find(s.runner_id);
+        if (team_id == rosters.runner_to_team.end()) {
+            continue;
+        }
+        auto i = index.find(team_id->second);
+        mean.push_back(s.mean);
+        deviation.push_back(s.deviation);
+        team.push_back(i == index.end() ? no_team : i->second);
+    }
+
+    const auto n = simulation.team_ids.size();
+    simulation.placements.assign(n * n, 0);
+    if (n == 0 || races == 0) {
+        return;
+    }
+
+    // Races are split into fixed chunks, each drawn from its own stream of
+    // (seed, chunk), so the same seed gives the same odds however many
+    // threads share the chunks out.
+    const unsigned long chunks = (races + chunk_races - 1) / chunk_races;
+    const auto workers = static_cast<unsigned int>(std::min<unsigned long>(chunks,
+        threads ? threads : std::max(1u, std::thread::hardware_concurrency())));
+    std::vector<std::vector<unsigned long>> counts(workers, std::vector<unsigned long>(n * n, 0));
+    std::atomic<unsigned long> next_chunk(0);
+    auto work = [&] (unsigned int worker) {
+        Kernel<Rules> kernel;
+        kernel.runners = mean.size();
+        kernel.teams = n;
+        kernel.mean = mean.data();
+        kernel.deviation = deviation.data();
+        kernel.team = team.data();
+        for (auto chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+            Rng rng((static_cast<std::uint64_t>(seed) << 32) + chunk);
+            kernel.run(rng, std::min(chunk_races, races - chunk * chunk_races), counts[worker]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int worker = 1; worker < workers; worker++) {
+        pool.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto &thread : pool) {
+        thread.join();
+    }
+
+    for (auto &c : counts) {
+        for (std::size_t i = 0; i < c.size(); i++) {
+            simulation.placements[i] += c[i];
+        }
+    }
+}
+
+template void simulate<Nfhs>(const Rosters &rosters, const Teams &teams, const std::vector<SeedTime> &seeds,
+    unsigned long races, unsigned int seed, Simulation &simulation, unsigned int threads);
+template void simulate<FourScorer>(const Rosters &rosters, const Teams &teams, const std::vector<SeedTime> &seeds,
+    unsigned long races, unsigned int seed, Simulation &simulation, unsigned int threads);
+template void simulate<SixDisplacer>(const Rosters &rosters, const Teams &teams, const std::vector<SeedTime> &seeds,
+    unsigned long races, unsigned int seed, Simulation &simulation, unsigned int threads);
+
+void output_simulation(std::ostream &os, const Teams &teams, const Simulation &simulation) {
+    const auto n = simulation.team_ids.size();
+
+    os << "PLACEMENT PROBABILITIES (" << simulation.races << " races)\n";
+    os << "==================================================================================\n";
+    os << '\n';
+    os << "Team      Win      Top 3    Top 5\n";
+    os << "----------------------------------------------------------------------------------\n";
+
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&] (std::size_t a, std::size_t b) {
+        return simulation.top_probability(a, 3) > simulation.top_probability(b, 3);
+    });
+
+    for (auto i : order) {
+        std::stringstream ss;
+        auto extend = [&] (unsigned int limit) {
+            for (auto j = ss.str().length(); j < limit; j++) {
+                ss << ' ';
+            }
+        };
+        auto percent = [&] (float p) {
+            ss << static_cast<int>(p * 1000 + 0.5f) / 10.0f << '%';
+        };
+        ss << teams.find(simulation.team_ids[i])->second.initials;
+        extend(10);
+        percent(simulation.probability(i, 1));
+        extend(19);
+        percent(simulation.top_probability(i, 3));
+        extend(28);
+        percent(simulation.top_probability(i, 5));
+        os << ss.str() << '\n';
+    }
+
+    os << "==================================================================================\n";
+}
@@ -0,0 +1,34 @@
+#ifndef SIMULATE_HPP
+#define SIMULATE_HPP
+
+#include <vector>
+#include "wildcat.hpp"
+
+// Expected time for one runner, e.g. from a seed time or season history.
+struct SeedTime {
+    RunnerId runner_id;
+    float mean;
+    float deviation;
+};
+
+// How often each team finished in each place over all simulated races.
+// Only teams with a full squad of seeded runners can score, so only those
+// are listed.
+struct Simulation {
+    std::vector<TeamId> team_ids;
+    std::vector<unsigned long> placements; // team_ids.size() x team_ids.size(), row-major
+    unsigned long races = 0;
+
+    float probability(std::size_t team, unsigned int place) const;
+    float top_probability(std::size_t team, unsigned int places) const;
+};
+
+// Spread over `threads` threads, every core when 0. The odds depend only
+// on the seed, not on how many threads ran.
+template <typename Rules = Nfhs>
+void simulate(const Rosters &rosters, const Teams &teams, const std::vector<SeedTime> &seeds,
+    unsigned long races, unsigned int seed, Simulation &simulation, unsigned int threads = 0);
+
+void output_simulation(std::ostream &os, const Teams &teams, const Simulation &simulation);
+
+#endif
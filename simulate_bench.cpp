@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include "simulate.hpp"
+
+// simulate-bench [races] [teams]
+//
+// Times the Monte Carlo simulator on a generated meet of `teams` teams
+// (20 by default) of seven seeded runners, over `races` races (200000 by
+// default): once on one thread and once on every core (at least two). The
+// two must give the same odds, or the bench fails.
+
+static double run_seconds(const Rosters &rosters, const Teams &teams, const std::vector<SeedTime> &seeds,
+        unsigned long races, unsigned int threads, Simulation &simulation) {
+    const auto start = std::chrono::steady_clock::now();
+    simulate(rosters, teams, seeds, races, 7, simulation, threads);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    const unsigned long races = argc > 1 ? std::atol(argv[1]) : 200000;
+    const unsigned int team_count = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    Rosters rosters;
+    Teams teams;
+    std::vector<SeedTime> seeds;
+    std::mt19937 random(42);
+    std::normal_distribution<float> team_mean(1080, 30);
+    RunnerId runner_id = 1000;
+    for (TeamId team_id = 0; team_id < static_cast<TeamId>(team_count); team_id++) {
+        teams[team_id].initials = "T" + std::to_string(team_id);
+        const auto mean = team_mean(random);
+        for (unsigned int i = 0; i < 7; i++, runner_id++) {
+            rosters.runner_to_team[runner_id] = team_id;
+            rosters.team_to_runners[team_id].push_back(runner_id);
+            seeds.push_back({ runner_id, mean + 8.0f * i, 20 });
+        }
+    }
+
+    const auto cores = std::max(2u, std::thread::hardware_concurrency());
+    Simulation one, all;
+    const auto one_seconds = run_seconds(rosters, teams, seeds, races, 1, one);
+    const auto all_seconds = run_seconds(rosters, teams, seeds, races, cores, all);
+    if (one.placements != all.placements) {
+        std::cerr << "simulate-bench: the odds depend on the thread count\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << races << " races, " << team_count << " teams of 7\n"
+        << "1 thread     " << races / one_seconds << " races/s\n"
+        << cores << " threads    " << races / all_seconds << " races/s\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include "splits.hpp"
+
+void make_splits(const Rosters &rosters, const std::vector<std::string> &checkpoints, Splits &splits) {
+    splits.checkpoints = checkpoints;
+    splits.runners.clear();
+    splits.teams.clear();
+    splits.index.clear();
+    splits.team_ids.clear();
+    splits.team_index.clear();
+
+    // team ids needn't be dense, a reloaded roster leaves gaps
+    std::map<TeamId, std::uint32_t> team_index;
+    for (auto &entry : rosters.runner_to_team) {
+        splits.index[entry.first] = splits.runners.size();
+        splits.runners.push_back(entry.first);
+        splits.teams.push_back(entry.second);
+        auto inserted = team_index.insert({ entry.second, splits.team_ids.size() });
+        if (inserted.second) {
+            splits.team_ids.push_back(entry.second);
+        }
+        splits.team_index.push_back(inserted.first->second);
+    }
+
+    splits.columns.assign(checkpoints.size(),
+        std::vector<float>(splits.runners.size(), std::numeric_limits<float>::quiet_NaN()));
+    splits.order.assign(checkpoints.size(), {});
+}
+
+bool record_split(Splits &splits, std::size_t checkpoint, RunnerId runner_id, float seconds) {
+    auto found = splits.index.find(runner_id);
+    if (found == splits.index.end() || checkpoint >= splits.columns.size()) {
+        return false;
+    }
+    const auto i = found->second;
+    auto &column = splits.columns[checkpoint];
+    auto &order = splits.order[checkpoint];
+
+    if (!std::isnan(column[i])) {
+        // a correction: take the runner out of the order and re-place them
+        order.erase(std::find(order.begin(), order.end(), i));
+    }
+    column[i] = seconds;
+
+    // splits nearly always arrive in order, so this is an append
+    auto at = std::upper_bound(order.begin(), order.end(), seconds,
+        [&] (float t, std::uint32_t j) {
+            return t < column[j];
+        });
+    order.insert(at, i);
+    return true;
+}
+
+bool split_deltas(const Splits &splits, std::size_t checkpoint, std::vector<float> &deltas) {
+    if (checkpoint >= splits.columns.size()) {
+        return false;
+    }
+    const auto &column = splits.columns[checkpoint];
+    const auto n = column.size();
+    deltas.resize(n);
+    if (checkpoint == 0) {
+        std::copy(column.begin(), column.end(), deltas.begin());
+        return true;
+    }
+    const auto *now = column.data();
+    const auto *before = splits.columns[checkpoint - 1].data();
+    auto *out = deltas.data();
+    // NaN in either column carries through
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = now[i] - before[i];
+    }
+    return true;
+}
+
+bool positions(const Splits &splits, std::size_t checkpoint, std::vector<std::uint32_t> &position) {
+    if (checkpoint >= splits.order.size()) {
+        return false;
+    }
+    const auto &order = splits.order[checkpoint];
+    position.assign(splits.runners.size(), 0);
+    for (std::size_t p = 0; p < order.size(); p++) {
+        position[order[p]] = p + 1;
+    }
+    return true;
+}
+
+bool position_changes(const Splits &splits, std::size_t checkpoint, std::vector<int> &changes) {
+    if (checkpoint >= splits.order.size()) {
+        return false;
+    }
+    const auto n = splits.runners.size();
+    changes.assign(n, 0);
+    if (checkpoint == 0) {
+        return true;
+    }
+    std::vector<std::uint32_t> now;
+    std::vector<std::uint32_t> before;
+    positions(splits, checkpoint, now);
+    positions(splits, checkpoint - 1, before);
+    for (std::size_t i = 0; i < n; i++) {
+        const bool both = now[i] && before[i];
+        changes[i] = both ? static_cast<int>(before[i]) - static_cast<int>(now[i]) : 0;
+    }
+    return true;
+}
+
+template <typename Rules>
+bool pack_spread(const Splits &splits, std::size_t checkpoint, std::map<TeamId, float> &spread) {
+    if (checkpoint >= splits.columns.size()) {
+        return false;
+    }
+    spread.clear();
+
+    // flat counters by dense team index beat a map here
+    const auto teams = splits.team_ids.size();
+    std::vector<unsigned int> count(teams, 0);
+    std::vector<float> first(teams, 0);
+
+    const auto &column = splits.columns[checkpoint];
+    for (auto i : splits.order[checkpoint]) {
+        const auto team = splits.team_index[i];
+        if (count[team] == 0) {
+            first[team] = column[i];
+        }
+        if (++count[team] == Rules::scorers) {
+            spread[splits.team_ids[team]] = column[i] - first[team];
+        }
+    }
+    return true;
+}
+
+bool standings(const Splits &splits, std::size_t checkpoint, Finishes &finishes) {
+    if (checkpoint >= splits.columns.size()) {
+        return false;
+    }
+    finishes.clear();
+    const auto &column = splits.columns[checkpoint];
+    for (auto i : splits.order[checkpoint]) {
+        finishes.push_back({ splits.runners[i], Time(column[i]), 0 });
+    }
+    return true;
+}
+
+template <typename Rules>
+bool output_splits(std::ostream &os, const Runners &runners, const Teams &teams, const Rosters &rosters,
+        const Splits &splits, std::size_t checkpoint) {
+    Finishes finishes;
+    Results results;
+    std::map<TeamId, float> spread;
+    std::vector<float> deltas;
+    std::vector<int> changes;
+    if (!standings(splits, checkpoint, finishes) ||
+        !pack_spread<Rules>(splits, checkpoint, spread) ||
+        !split_deltas(splits, checkpoint, deltas) ||
+        !position_changes(splits, checkpoint, changes)) {
+        return false;
+    }
+    score_race<Rules>(runners, teams, rosters, finishes, results);
+
+    std::stringstream ss;
+    auto extend = [&] (std::size_t limit) {
+        for (auto j = ss.str().length(); j < limit; j++) {
+            ss << ' ';
+        }
+    };
+    auto flush = [&] {
+        os << ss.str() << '\n';
+        ss.str("");
+    };
+
+    os << "SPLITS AT " << splits.checkpoints[checkpoint] << '\n';
+    os << "==================================================================================\n";
+    os << '\n';
+    os << "Place  Team      Score    Spread\n";
+    os << "----------------------------------------------------------------------------------\n";
+    for (auto &result : results) {
+        if (!result.squad.score) {
+            continue;
+        }
+        auto team = teams.find(result.team_id);
+        ss << result.place;
+        extend(7);
+        ss << (team == teams.end() ? std::string() : team->second.initials);
+        extend(17);
+        ss << result.squad.score;
+        extend(26);
+        auto gap = spread.find(result.team_id);
+        if (gap != spread.end()) {
+            ss << Time(gap->second);
+        }
+        flush();
+    }
+
+    os << '\n';
+    os << "Place  Name                     Team      Time        Split       Gained\n";
+    os << "----------------------------------------------------------------------------------\n";
+    const auto &column = splits.columns[checkpoint];
+    const auto &order = splits.order[checkpoint];
+    for (std::size_t p = 0; p < order.size(); p++) {
+        const auto i = order[p];
+        auto runner = runners.find(splits.runners[i]);
+        auto team = teams.find(splits.teams[i]);
+        ss << p + 1;
+        extend(7);
+        ss << (runner == runners.end() ? std::string() : runner->second.name);
+        extend(32);
+        ss << (team == teams.end() ? std::string() : team->second.initials);
+        extend(42);
+        ss << Time(column[i]);
+        extend(54);
+        if (!std::isnan(deltas[i])) {
+            ss << Time(deltas[i]);
+        }
+        extend(66);
+        if (changes[i]) {
+            ss << std::showpos << changes[i] << std::noshowpos;
+        }
+        flush();
+    }
+
+    os << "==================================================================================\n";
+    return true;
+}
+
+template bool pack_spread<Nfhs>(const Splits &splits, std::size_t checkpoint, std::map<TeamId, float> &spread);
+template bool pack_spread<FourScorer>(const Splits &splits, std::size_t checkpoint, std::map<TeamId, float> &spread);
+template bool pack_spread<SixDisplacer>(const Splits &splits, std::size_t checkpoint, std::map<TeamId, float> &spread);
+
+template bool output_splits<Nfhs>(std::ostream &os, const Runners &runners, const Teams &teams, const Rosters &rosters,
+    const Splits &splits, std::size_t checkpoint);
+template bool output_splits<FourScorer>(std::ostream &os, const Runners &runners, const Teams &teams, const Rosters &rosters,
+    const Splits &splits, std::size_t checkpoint);
+template bool output_splits<SixDisplacer>(std::ostream &os, const Runners &runners, const Teams &teams, const Rosters &rosters,
+    const Splits &splits, std::size_t checkpoint);
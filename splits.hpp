@@ -0,0 +1,59 @@
+#ifndef SPLITS_HPP
+#define SPLITS_HPP
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// Checkpoint times stored by column: one float per rostered runner per
+// checkpoint, NaN until the runner passes. Runners are addressed by a
+// dense index so every pass over a checkpoint is a flat array walk.
+struct Splits {
+    std::vector<std::string> checkpoints;
+    std::vector<RunnerId> runners;
+    std::vector<TeamId> teams;
+    std::map<RunnerId, std::uint32_t> index;
+    // each runner's team as a dense index into team_ids
+    std::vector<TeamId> team_ids;
+    std::vector<std::uint32_t> team_index;
+    std::vector<std::vector<float>> columns;
+    // dense indexes in passing order, kept sorted as splits arrive
+    std::vector<std::vector<std::uint32_t>> order;
+};
+
+void make_splits(const Rosters &rosters, const std::vector<std::string> &checkpoints, Splits &splits);
+
+// false if the runner isn't on the roster or the checkpoint doesn't exist
+bool record_split(Splits &splits, std::size_t checkpoint, RunnerId runner_id, float seconds);
+
+// The rest are false, and leave their output alone, if the checkpoint
+// doesn't exist.
+
+// time since the previous checkpoint (since the gun for the first), NaN
+// for runners missing either time
+bool split_deltas(const Splits &splits, std::size_t checkpoint, std::vector<float> &deltas);
+
+// 1-based position at a checkpoint, 0 if not yet through
+bool positions(const Splits &splits, std::size_t checkpoint, std::vector<std::uint32_t> &position);
+
+// places gained since the previous checkpoint (negative: lost), 0 for
+// runners missing either checkpoint
+bool position_changes(const Splits &splits, std::size_t checkpoint, std::vector<int> &changes);
+
+// first to last scorer gap, for teams with a full scoring pack through
+template <typename Rules = Nfhs>
+bool pack_spread(const Splits &splits, std::size_t checkpoint, std::map<TeamId, float> &spread);
+
+// runners through a checkpoint, in order, ready for score_race()
+bool standings(const Splits &splits, std::size_t checkpoint, Finishes &finishes);
+
+// The race as it stood at a checkpoint: team scores with each pack's
+// spread, then every runner through with their split and places gained.
+template <typename Rules = Nfhs>
+bool output_splits(std::ostream &os, const Runners &runners, const Teams &teams, const Rosters &rosters,
+    const Splits &splits, std::size_t checkpoint);
+
+#endif
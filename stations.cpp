@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "stations.hpp"
+
+enum PacketType : std::uint8_t {
+    PT_TIMES = 1,
+    PT_HELLO,
+    PT_PING,
+    PT_PONG,
+    PT_NACK,
+};
+
+static const std::uint8_t protocol_version = 1;
+static const std::size_t header_size = 5;
+static const std::uint32_t times_per_packet = 64;
+static const std::uint64_t ping_interval_us = 250000;
+static const std::uint64_t hello_interval_us = 100000;
+static const std::uint64_t nack_interval_us = 20000;
+static const std::size_t offset_samples = 8;
+
+std::uint64_t monotonic_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Packet {
+    std::vector<unsigned char> bytes;
+
+    Packet(PacketType type, std::uint8_t station)
+    : bytes({ 'W', 'S', protocol_version, type, station })
+    {}
+
+    void put(std::uint64_t value, unsigned int size) {
+        for (unsigned int i = 0; i < size; i++) {
+            bytes.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+};
+
+static std::uint64_t get(const unsigned char *&p, unsigned int size) {
+    std::uint64_t value = 0;
+    for (unsigned int i = 0; i < size; i++) {
+        value |= static_cast<std::uint64_t>(*p++) << (8 * i);
+    }
+    return value;
+}
+
+static void send_packet(int fd, const Packet &packet, const sockaddr_in &to) {
+    sendto(fd, packet.bytes.data(), packet.bytes.size(), 0,
+        reinterpret_cast<const sockaddr *>(&to), sizeof to);
+}
+
+StationReceiver::StationReceiver()
+: fd(-1)
+, running(false)
+, gun_us(0)
+, last_ping_us(0)
+{}
+
+StationReceiver::~StationReceiver() {
+    stop();
+}
+
+bool StationReceiver::listen(std::uint16_t port) {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "StationReceiver::listen(): Can't open socket\n";
+        return false;
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof address) < 0) {
+        std::cerr << "StationReceiver::listen(): Can't bind port " << port << '\n';
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    set_gun();
+    running = true;
+    thread = std::thread(&StationReceiver::run, this);
+    return true;
+}
+
+void StationReceiver::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void StationReceiver::set_gun() {
+    set_gun(monotonic_us());
+}
+
+void StationReceiver::set_gun(std::uint64_t gun_us) {
+    this->gun_us = gun_us;
+}
+
+void StationReceiver::drain(std::vector<StationTime> &times) {
+    std::lock_guard<std::mutex> lock(mutex);
+    times.insert(times.end(), out.begin(), out.end());
+    out.clear();
+}
+
+bool StationReceiver::get_offset(std::uint8_t station, long long &offset_us) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto remote = remotes.find(station);
+    if (remote == remotes.end() || !remote->second.synced) {
+        return false;
+    }
+    offset_us = remote->second.offset_us;
+    return true;
+}
+
+void StationReceiver::run() {
+    unsigned char buffer[2048];
+    while (running) {
+        pollfd p = { fd, POLLIN, 0 };
+        poll(&p, 1, 10);
+
+        for (;;) {
+            sockaddr_in from;
+            socklen_t length = sizeof from;
+            const auto size = recvfrom(fd, buffer, sizeof buffer, MSG_DONTWAIT,
+                reinterpret_cast<sockaddr *>(&from), &length);
+            if (size <= 0) {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            handle(buffer, size, from, monotonic_us());
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = monotonic_us();
+        for (auto &entry : remotes) {
+            auto &remote = entry.second;
+            if (!remote.early.empty()) {
+                send_nack(entry.first, remote, remote.early.begin()->first, now);
+            }
+        }
+        if (now - last_ping_us >= ping_interval_us) {
+            last_ping_us = now;
+            for (auto &entry : remotes) {
+                Packet ping(PT_PING, entry.first);
+                ping.put(now, 8);
+                send_packet(fd, ping, entry.second.address);
+            }
+        }
+    }
+}
+
+void StationReceiver::handle(const unsigned char *packet, std::size_t size, const sockaddr_in &from, std::uint64_t now) {
+    if (size < header_size || packet[0] != 'W' || packet[1] != 'S' || packet[2] != protocol_version) {
+        return;
+    }
+    const auto type = packet[3];
+    const auto id = packet[4];
+    const auto *p = packet + header_size;
+    const auto *end = packet + size;
+
+    auto &remote = remotes[id];
+    remote.address = from;
+
+    switch (type) {
+    case PT_TIMES: {
+        if (end - p < 5) {
+            return;
+        }
+        const auto first = static_cast<std::uint32_t>(get(p, 4));
+        const auto count = static_cast<std::uint32_t>(get(p, 1));
+        if (static_cast<std::size_t>(end - p) < count * 8u) {
+            return;
+        }
+        for (std::uint32_t i = 0; i < count; i++) {
+            const auto station_us = get(p, 8);
+            if (first + i >= remote.next_seq) {
+                remote.early[first + i] = station_us;
+            }
+        }
+        deliver(id, remote);
+        if (!remote.early.empty()) {
+            send_nack(id, remote, remote.early.begin()->first, now);
+        }
+        break;
+    }
+    case PT_HELLO: {
+        if (end - p < 4) {
+            return;
+        }
+        const auto next = static_cast<std::uint32_t>(get(p, 4));
+        if (next > remote.next_seq) {
+            send_nack(id, remote, remote.early.empty() ? next : remote.early.begin()->first, now);
+        }
+        break;
+    }
+    case PT_PONG: {
+        if (end - p < 24) {
+            return;
+        }
+        const auto t1 = static_cast<long long>(get(p, 8));
+        const auto t2 = static_cast<long long>(get(p, 8));
+        const auto t3 = static_cast<long long>(get(p, 8));
+        const auto t4 = static_cast<long long>(now);
+
+        // NTP: the sample with the shortest round trip is the most trustworthy
+        const auto delay = (t4 - t1) - (t3 - t2);
+        const auto offset = ((t2 - t1) + (t3 - t4)) / 2;
+        remote.samples.push_back(std::make_pair(offset, delay));
+        if (remote.samples.size() > offset_samples) {
+            remote.samples.erase(remote.samples.begin());
+        }
+        const auto best = std::min_element(remote.samples.begin(), remote.samples.end(),
+            [] (const std::pair<long long, long long> &a, const std::pair<long long, long long> &b) {
+                return a.second < b.second;
+            });
+        remote.offset_us = best->first;
+        remote.synced = true;
+        deliver(id, remote);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// caller holds mutex
+void StationReceiver::deliver(std::uint8_t id, Remote &remote) {
+    while (!remote.early.empty() && remote.early.begin()->first == remote.next_seq) {
+        remote.ready.push_back(remote.early.begin()->second);
+        remote.early.erase(remote.early.begin());
+        remote.next_seq++;
+    }
+    if (!remote.synced) {
+        return;
+    }
+    const auto gun = static_cast<long long>(gun_us.load());
+    for (auto station_us : remote.ready) {
+        const auto receiver_us = static_cast<long long>(station_us) - remote.offset_us;
+        out.push_back({ id, (receiver_us - gun) / 1000000.0f });
+    }
+    remote.ready.clear();
+}
+
+void StationReceiver::send_nack(std::uint8_t id, Remote &remote, std::uint32_t until, std::uint64_t now) {
+    if (until <= remote.next_seq || now - remote.last_nack_us < nack_interval_us) {
+        return;
+    }
+    remote.last_nack_us = now;
+    Packet nack(PT_NACK, id);
+    nack.put(remote.next_seq, 4);
+    nack.put(std::min<std::uint32_t>(until - remote.next_seq, 0xFFFF), 2);
+    send_packet(fd, nack, remote.address);
+}
+
+TimingStation::TimingStation(std::uint8_t id, long long clock_offset_us, float loss)
+: id(id)
+, clock_offset_us(clock_offset_us)
+, loss(loss)
+, fd(-1)
+, running(false)
+, sent(0)
+, rng(id * 2654435761u + 1)
+{}
+
+TimingStation::~TimingStation() {
+    stop();
+}
+
+bool TimingStation::connect(const std::string &host, std::uint16_t port) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found) {
+        std::cerr << "TimingStation::connect(): Can't resolve \"" << host << "\"\n";
+        return false;
+    }
+    std::memcpy(&receiver, found->ai_addr, sizeof receiver);
+    receiver.sin_port = htons(port);
+    freeaddrinfo(found);
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "TimingStation::connect(): Can't open socket\n";
+        return false;
+    }
+
+    running = true;
+    thread = std::thread(&TimingStation::run, this);
+    return true;
+}
+
+void TimingStation::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void TimingStation::record() {
+    std::lock_guard<std::mutex> lock(mutex);
+    history.push_back(now());
+}
+
+std::uint64_t TimingStation::now() const {
+    return monotonic_us() + clock_offset_us;
+}
+
+void TimingStation::send_times(std::uint32_t first, std::uint32_t count, bool may_drop) {
+    std::vector<std::uint64_t> slice;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first >= history.size()) {
+            return;
+        }
+        count = std::min<std::uint32_t>(count, history.size() - first);
+        slice.assign(history.begin() + first, history.begin() + first + count);
+    }
+
+    for (std::uint32_t i = 0; i < slice.size(); i += times_per_packet) {
+        const auto n = std::min<std::uint32_t>(times_per_packet, slice.size() - i);
+        rng = rng * 1664525u + 1013904223u;
+        if (may_drop && (rng >> 8) * (1.0f / 16777216.0f) < loss) {
+            continue;
+        }
+        Packet packet(PT_TIMES, id);
+        packet.put(first + i, 4);
+        packet.put(n, 1);
+        for (std::uint32_t j = 0; j < n; j++) {
+            packet.put(slice[i + j], 8);
+        }
+        send_packet(fd, packet, receiver);
+    }
+}
+
+void TimingStation::run() {
+    unsigned char buffer[2048];
+    std::uint64_t last_hello = 0;
+    while (running) {
+        pollfd p = { fd, POLLIN, 0 };
+        poll(&p, 1, 10);
+
+        for (;;) {
+            const auto size = recv(fd, buffer, sizeof buffer, MSG_DONTWAIT);
+            if (size <= 0) {
+                break;
+            }
+            const auto received = now();
+            if (size < static_cast<ssize_t>(header_size) || buffer[0] != 'W' || buffer[1] != 'S' ||
+                buffer[2] != protocol_version || buffer[4] != id) {
+                continue;
+            }
+            const unsigned char *q = buffer + header_size;
+            if (buffer[3] == PT_PING && size >= static_cast<ssize_t>(header_size + 8)) {
+                const auto t1 = get(q, 8);
+                Packet pong(PT_PONG, id);
+                pong.put(t1, 8);
+                pong.put(received, 8);
+                pong.put(now(), 8);
+                send_packet(fd, pong, receiver);
+            } else if (buffer[3] == PT_NACK && size >= static_cast<ssize_t>(header_size + 6)) {
+                const auto first = static_cast<std::uint32_t>(get(q, 4));
+                const auto count = static_cast<std::uint32_t>(get(q, 2));
+                send_times(first, count, true);
+            }
+        }
+
+        std::uint32_t recorded;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            recorded = history.size();
+        }
+        if (sent < recorded) {
+            send_times(sent, recorded - sent, true);
+            sent = recorded;
+        }
+
+        const auto t = monotonic_us();
+        if (t - last_hello >= hello_interval_us) {
+            last_hello = t;
+            Packet hello(PT_HELLO, id);
+            hello.put(recorded, 4);
+            send_packet(fd, hello, receiver);
+        }
+    }
+}
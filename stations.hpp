@@ -0,0 +1,108 @@
+#ifndef STATIONS_HPP
+#define STATIONS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+
+// Remote timing stations report over UDP. Every time a station records
+// gets a sequence number; the receiver asks for gaps again (NACK) and
+// estimates each station's clock offset NTP-style from ping round trips,
+// so times come out in station order on the receiver's race clock.
+//
+// Packets start with 'W' 'S', a version, a type and the station id.
+//   Times  station -> receiver  u32 first seq, u8 count, count x u64 station us
+//   Hello  station -> receiver  u32 next seq (lets the receiver see lost tails)
+//   Ping   receiver -> station  u64 t1 receiver us
+//   Pong   station -> receiver  u64 t1, u64 t2 station us, u64 t3 station us
+//   Nack   receiver -> station  u32 first seq, u16 count
+
+struct StationTime {
+    std::uint8_t station;
+    float seconds;
+};
+
+class StationReceiver {
+public:
+    StationReceiver();
+    ~StationReceiver();
+
+    bool listen(std::uint16_t port);
+    void stop();
+
+    // race clock zero: now, or a monotonic_us() reading; listen() starts
+    // the clock, so a receiver started before the gun sets it again
+    void set_gun();
+    void set_gun(std::uint64_t gun_us);
+
+    // corrected times received since the last drain
+    void drain(std::vector<StationTime> &times);
+
+    // station clock minus receiver clock, once known
+    bool get_offset(std::uint8_t station, long long &offset_us);
+
+private:
+    struct Remote {
+        sockaddr_in address;
+        std::uint32_t next_seq = 0;
+        std::map<std::uint32_t, std::uint64_t> early;
+        std::vector<std::uint64_t> ready;
+        std::vector<std::pair<long long, long long>> samples; // offset, delay
+        long long offset_us = 0;
+        bool synced = false;
+        std::uint64_t last_nack_us = 0;
+    };
+
+    void run();
+    void handle(const unsigned char *packet, std::size_t size, const sockaddr_in &from, std::uint64_t now);
+    void deliver(std::uint8_t id, Remote &remote);
+    void send_nack(std::uint8_t id, Remote &remote, std::uint32_t until, std::uint64_t now);
+
+    int fd;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<std::uint64_t> gun_us;
+    std::map<std::uint8_t, Remote> remotes;
+    std::mutex mutex;
+    std::vector<StationTime> out;
+    std::uint64_t last_ping_us;
+};
+
+// The station side. A real station calls record() from its timer; the
+// clock offset and loss rate let it stand in for one on loopback.
+class TimingStation {
+public:
+    TimingStation(std::uint8_t id, long long clock_offset_us = 0, float loss = 0);
+    ~TimingStation();
+
+    bool connect(const std::string &host, std::uint16_t port);
+    void stop();
+
+    void record();
+
+private:
+    std::uint64_t now() const;
+    void run();
+    void send_times(std::uint32_t first, std::uint32_t count, bool may_drop);
+
+    std::uint8_t id;
+    long long clock_offset_us;
+    float loss;
+    int fd;
+    sockaddr_in receiver;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::mutex mutex;
+    std::vector<std::uint64_t> history;
+    std::uint32_t sent;
+    unsigned int rng;
+};
+
+std::uint64_t monotonic_us();
+
+#endif
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <thread>
+#include "parse.hpp"
+#include "trace.hpp"
+
+static const char trace_magic[4] = { 'W', 'C', 'T', 'R' };
+static const char trace_version = 1;
+
+TraceRecorder::TraceRecorder()
+: start(std::chrono::steady_clock::now())
+{}
+
+void TraceRecorder::record(EventKind kind, std::int32_t value) {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    events.push_back({
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()),
+        kind,
+        value,
+    });
+}
+
+const std::vector<Event> &TraceRecorder::get_events() const {
+    return events;
+}
+
+bool TraceRecorder::save(const std::string &trace_file) const {
+    return save_trace(trace_file, events);
+}
+
+bool save_trace(const std::string &trace_file, const std::vector<Event> &events) {
+    std::string out(trace_magic, sizeof trace_magic);
+    out.push_back(trace_version);
+    put_varint(out, events.size());
+
+    std::uint64_t last = 0;
+    for (auto &event : events) {
+        put_varint(out, event.microseconds - last);
+        out.push_back(static_cast<char>(event.kind));
+        // zigzag, so small negative values stay small
+        put_varint(out, (static_cast<std::uint32_t>(event.value) << 1) ^ static_cast<std::uint32_t>(event.value >> 31));
+        last = event.microseconds;
+    }
+
+    std::ofstream file(trace_file, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "save_trace(): Can't open \"" << trace_file << "\"\n";
+        return false;
+    }
+    file.write(out.data(), out.size());
+    return true;
+}
+
+bool load_trace(const std::string &trace_file, std::vector<Event> &events) {
+
+    events.clear();
+
+    std::string in;
+    if (!read_file(trace_file, in)) {
+        std::cerr << "load_trace(): No file \"" << trace_file << "\"\n";
+        return false;
+    }
+
+    if (in.size() < sizeof trace_magic + 1 ||
+        !std::equal(trace_magic, trace_magic + sizeof trace_magic, in.begin()) ||
+        in[sizeof trace_magic] != trace_version) {
+        std::cerr << "load_trace() with \"" << trace_file << "\": not a trace\n";
+        return false;
+    }
+
+    std::size_t pos = sizeof trace_magic + 1;
+    std::uint64_t count;
+    if (!get_varint(in, pos, count)) {
+        std::cerr << "load_trace() with \"" << trace_file << "\": truncated\n";
+        return false;
+    }
+
+    std::uint64_t now = 0;
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::uint64_t delta;
+        std::uint64_t value;
+        if (!get_varint(in, pos, delta) || pos >= in.size()) {
+            std::cerr << "load_trace() with \"" << trace_file << "\": truncated\n";
+            return false;
+        }
+        const auto kind = static_cast<EventKind>(in[pos++]);
+        if (!get_varint(in, pos, value)) {
+            std::cerr << "load_trace() with \"" << trace_file << "\": truncated\n";
+            return false;
+        }
+        now += delta;
+        const auto zigzag = static_cast<std::uint32_t>(value);
+        events.push_back({ now, kind, static_cast<std::int32_t>((zigzag >> 1) ^ -(zigzag & 1)) });
+    }
+
+    return true;
+}
+
+void synthesize_trace(const Rosters &rosters, float seconds, unsigned int seed, std::vector<Event> &events) {
+
+    events.clear();
+
+    std::vector<RunnerId> order;
+    for (auto &entry : rosters.runner_to_team) {
+        order.push_back(entry.first);
+    }
+    std::mt19937 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    const std::uint64_t first_finish = 10 * 60 * 1000000ull;
+    const std::uint64_t scan_lag = 2 * 1000000ull;
+    const auto gap = static_cast<std::uint64_t>(seconds * 1000000);
+
+    events.push_back({ 0, EventKind::Gui, static_cast<std::int32_t>(GuiAction::Start) });
+    for (std::size_t i = 0; i < order.size(); i++) {
+        const auto finish = first_finish + i * gap;
+        events.push_back({ finish, EventKind::Button, 0 });
+        events.push_back({ finish + scan_lag, EventKind::Barcode, order[i] });
+    }
+    std::stable_sort(events.begin(), events.end(), [] (const Event &a, const Event &b) {
+        return a.microseconds < b.microseconds;
+    });
+}
+
+void replay(const std::vector<Event> &events, float speed, Wildcat &w, ReplayStats &stats) {
+
+    stats = ReplayStats();
+
+    w.times.clear();
+    w.barcodes.clear();
+    w.finishes.clear();
+
+    std::vector<double> latencies;
+    latencies.reserve(events.size());
+
+    // as in the GUI, the timer only stamps finishes between Start and Stop
+    std::uint64_t gun = 0;
+    bool running = false;
+    const auto wall_start = std::chrono::steady_clock::now();
+    for (auto &event : events) {
+        auto due = wall_start;
+        if (speed > 0) {
+            due += std::chrono::microseconds(static_cast<std::uint64_t>(event.microseconds / speed));
+            std::this_thread::sleep_until(due);
+        } else {
+            due = std::chrono::steady_clock::now();
+        }
+
+        switch (event.kind) {
+        case EventKind::Button:
+            if (!running) {
+                continue;
+            }
+            w.times.push_back((event.microseconds - gun) / 1000000.0f);
+            break;
+        case EventKind::Barcode:
+            w.barcodes.push_back(event.value);
+            break;
+        case EventKind::Gui:
+            if (event.value == static_cast<std::int32_t>(GuiAction::Start)) {
+                gun = event.microseconds;
+                running = true;
+            } else if (event.value == static_cast<std::int32_t>(GuiAction::Stop)) {
+                running = false;
+            }
+            continue;
+        }
+
+        make_finishes(w.times, w.barcodes, w.finishes);
+        score(w);
+
+        const auto done = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::micro>(done - due).count());
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    stats.events = latencies.size();
+    if (latencies.empty()) {
+        return;
+    }
+
+    double total = 0;
+    for (auto latency : latencies) {
+        total += latency;
+    }
+    stats.mean_latency_us = total / latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    stats.p99_latency_us = latencies[latencies.size() * 99 / 100];
+    stats.max_latency_us = latencies.back();
+}
+
+std::ostream &operator<<(std::ostream &os, const ReplayStats &stats) {
+    os << stats.events << " events in " << stats.seconds << " s";
+    if (stats.seconds > 0) {
+        os << " (" << stats.events / stats.seconds << " events/s)";
+    }
+    os << ", latency mean " << stats.mean_latency_us << " us";
+    os << ", p99 " << stats.p99_latency_us << " us";
+    os << ", max " << stats.max_latency_us << " us";
+    return os;
+}
@@ -0,0 +1,69 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+enum class EventKind : std::uint8_t {
+    Button,  // value: joystick button
+    Barcode, // value: RunnerId
+    Gui,     // value: GuiAction
+};
+
+enum class GuiAction : std::int32_t {
+    Start,
+    Stop,
+    LoadRoster,
+    LoadBarcodes,
+    LoadResults,
+    ExportResults,
+    PrettyPrintResults,
+};
+
+struct Event {
+    std::uint64_t microseconds; // since the recorder was created
+    EventKind kind;
+    std::int32_t value;
+};
+
+// Stamps events with a monotonic clock as they happen. Traces are stored
+// as varint deltas, a few bytes per event.
+class TraceRecorder {
+public:
+    TraceRecorder();
+    void record(EventKind kind, std::int32_t value);
+    const std::vector<Event> &get_events() const;
+    bool save(const std::string &trace_file) const;
+private:
+    std::chrono::steady_clock::time_point start;
+    std::vector<Event> events;
+};
+
+bool save_trace(const std::string &trace_file, const std::vector<Event> &events);
+bool load_trace(const std::string &trace_file, std::vector<Event> &events);
+
+// A race of every rostered runner finishing `seconds` apart, for desk
+// benchmarks when no recorded meet is at hand.
+void synthesize_trace(const Rosters &rosters, float seconds, unsigned int seed, std::vector<Event> &events);
+
+struct ReplayStats {
+    std::size_t events = 0;
+    double seconds = 0;
+    double mean_latency_us = 0;
+    double p99_latency_us = 0;
+    double max_latency_us = 0;
+};
+
+// Feeds events through the live path (button -> time stamp, barcode ->
+// finish, rescore) at `speed` times real time, or as fast as possible
+// when speed is 0. Buttons pressed outside Start..Stop are ignored, as the
+// GUI ignores them. Latency runs from when an event was due to when its
+// standings were ready.
+void replay(const std::vector<Event> &events, float speed, Wildcat &w, ReplayStats &stats);
+
+std::ostream &operator<<(std::ostream &os, const ReplayStats &stats);
+
+#endif
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <queue>
+#include "parse.hpp"
+#include "waves.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WAVES_X86 1
+#endif
+
+// net = gun - offset over [begin, n). -O2 leaves the plain loop scalar, so
+// the wide passes are written out and picked by the same CPU check as the
+// delimiter scanner in parse.cpp; the scalar loop finishes the tail.
+static void subtract_scalar(const float *gun, const float *offset, float *net, std::size_t begin, std::size_t n) {
+    for (auto i = begin; i < n; i++) {
+        net[i] = gun[i] - offset[i];
+    }
+}
+
+#ifdef WAVES_X86
+__attribute__((target("sse2")))
+static void subtract_sse2(const float *gun, const float *offset, float *net, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(net + i, _mm_sub_ps(_mm_loadu_ps(gun + i), _mm_loadu_ps(offset + i)));
+    }
+    subtract_scalar(gun, offset, net, i, n);
+}
+
+__attribute__((target("avx2")))
+static void subtract_avx2(const float *gun, const float *offset, float *net, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(net + i, _mm256_sub_ps(_mm256_loadu_ps(gun + i), _mm256_loadu_ps(offset + i)));
+    }
+    subtract_scalar(gun, offset, net, i, n);
+}
+#endif
+
+void assign_waves(const Waves &waves, const Rosters &rosters,
+        const std::vector<float> &times, const std::vector<RunnerId> &barcodes, NetTimes &net_times) {
+
+    const auto n = std::min(times.size(), barcodes.size());
+    net_times.runners.assign(barcodes.begin(), barcodes.begin() + n);
+    net_times.gun.assign(times.begin(), times.begin() + n);
+    net_times.offset.resize(n);
+    net_times.slot_of.resize(n);
+    net_times.order.clear();
+    net_times.moved.clear();
+    net_times.slot_offsets = waves.offsets;
+    if (net_times.slot_offsets.empty()) {
+        net_times.slot_offsets.push_back(0);
+    }
+    const auto wave_count = net_times.slot_offsets.size();
+    net_times.slots.assign(wave_count, {});
+
+    std::map<RunnerId, std::uint32_t> own_slots;
+    for (std::uint32_t i = 0; i < n; i++) {
+        const auto runner_id = net_times.runners[i];
+        std::size_t slot = 0;
+        auto own = waves.runner_offsets.find(runner_id);
+        auto runner_wave = waves.runner_waves.find(runner_id);
+        auto team = rosters.runner_to_team.find(runner_id);
+        if (own != waves.runner_offsets.end()) {
+            auto found = own_slots.find(runner_id);
+            if (found == own_slots.end()) {
+                found = own_slots.insert(std::make_pair(runner_id, static_cast<std::uint32_t>(net_times.slots.size()))).first;
+                net_times.slot_offsets.push_back(own->second);
+                net_times.slots.push_back({});
+            }
+            slot = found->second;
+        } else if (runner_wave != waves.runner_waves.end()) {
+            slot = runner_wave->second;
+        } else if (team != rosters.runner_to_team.end() && waves.team_waves.count(team->second)) {
+            slot = waves.team_waves.find(team->second)->second;
+        }
+        if (slot >= net_times.slots.size() || (slot >= wave_count && own == waves.runner_offsets.end())) {
+            slot = 0;
+        }
+        net_times.slots[slot].push_back(i);
+        net_times.slot_of[i] = slot;
+        net_times.offset[i] = net_times.slot_offsets[slot];
+    }
+
+    // the timer only runs forward, so this is nearly always already true
+    const auto &gun = net_times.gun;
+    for (auto &slot : net_times.slots) {
+        auto by_gun = [&] (std::uint32_t a, std::uint32_t b) {
+            return gun[a] < gun[b];
+        };
+        if (!std::is_sorted(slot.begin(), slot.end(), by_gun)) {
+            std::stable_sort(slot.begin(), slot.end(), by_gun);
+        }
+    }
+
+    compute_net_times(net_times);
+    rank_net_times(net_times);
+}
+
+void set_wave_offset(Waves &waves, NetTimes &net_times, unsigned int wave, float seconds) {
+    if (wave >= waves.offsets.size()) {
+        waves.offsets.resize(wave + 1, 0);
+    }
+    waves.offsets[wave] = seconds;
+    if (wave >= net_times.slot_offsets.size()) {
+        return;
+    }
+    net_times.slot_offsets[wave] = seconds;
+    if (std::find(net_times.moved.begin(), net_times.moved.end(), wave) == net_times.moved.end()) {
+        net_times.moved.push_back(wave);
+    }
+    auto *offset = net_times.offset.data();
+    for (auto i : net_times.slots[wave]) {
+        offset[i] = seconds;
+    }
+}
+
+void compute_net_times(NetTimes &net_times) {
+    const auto n = net_times.gun.size();
+    net_times.net.resize(n);
+    const auto *gun = net_times.gun.data();
+    const auto *offset = net_times.offset.data();
+    auto *net = net_times.net.data();
+    switch (scan_isa()) {
+#ifdef WAVES_X86
+    case ScanIsa::Avx2:
+        subtract_avx2(gun, offset, net, n);
+        break;
+    case ScanIsa::Sse2:
+        subtract_sse2(gun, offset, net, n);
+        break;
+#endif
+    default:
+        subtract_scalar(gun, offset, net, 0, n);
+        break;
+    }
+}
+
+void rank_net_times(NetTimes &net_times) {
+    const auto &net = net_times.net;
+    auto &order = net_times.order;
+    auto by_net = [&] (std::uint32_t a, std::uint32_t b) {
+        return net[a] < net[b] || (net[a] == net[b] && a < b);
+    };
+
+    if (net_times.moved.size() == 1 && order.size() == net.size()) {
+        // everyone else kept their order: take the moved wave out and
+        // merge it back in
+        const auto moved = net_times.moved[0];
+        const auto &members = net_times.slots[moved];
+        std::vector<std::uint32_t> rest;
+        rest.reserve(order.size() - members.size());
+        for (auto i : order) {
+            if (net_times.slot_of[i] != moved) {
+                rest.push_back(i);
+            }
+        }
+        std::merge(rest.begin(), rest.end(), members.begin(), members.end(), order.begin(), by_net);
+        net_times.moved.clear();
+        return;
+    }
+    net_times.moved.clear();
+
+    order.clear();
+    order.reserve(net.size());
+
+    struct Head {
+        float net;
+        std::uint32_t finish;
+        std::uint32_t slot;
+        std::uint32_t position;
+    };
+    auto later = [] (const Head &a, const Head &b) {
+        return a.net > b.net || (a.net == b.net && a.finish > b.finish);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    for (std::uint32_t slot = 0; slot < net_times.slots.size(); slot++) {
+        const auto &members = net_times.slots[slot];
+        if (!members.empty()) {
+            heads.push({ net[members[0]], members[0], slot, 0 });
+        }
+    }
+    while (!heads.empty()) {
+        auto head = heads.top();
+        heads.pop();
+        order.push_back(head.finish);
+        const auto &members = net_times.slots[head.slot];
+        // drain this slot while it stays ahead of every other slot
+        for (auto position = head.position + 1; position < members.size(); position++) {
+            const Head next = { net[members[position]], members[position], head.slot, position };
+            if (!heads.empty() && later(next, heads.top())) {
+                heads.push(next);
+                break;
+            }
+            order.push_back(next.finish);
+        }
+    }
+}
+
+void net_finishes(const NetTimes &net_times, Finishes &finishes) {
+    finishes.clear();
+    finishes.reserve(net_times.order.size());
+    for (auto i : net_times.order) {
+        finishes.push_back({ net_times.runners[i], Time(net_times.net[i]), 0 });
+    }
+}
+
+bool import_waves(const std::string &wave_file, const Teams &teams, Waves &waves) {
+
+    waves.offsets.clear();
+    waves.team_waves.clear();
+    waves.runner_waves.clear();
+    waves.runner_offsets.clear();
+
+    std::string contents;
+    if (!read_file(wave_file, contents)) {
+        std::cerr << "import_waves(): No file \"" << wave_file << "\"\n";
+        return false;
+    }
+
+    std::map<std::string, TeamId> initials;
+    for (auto &team : teams) {
+        initials[team.second.initials] = team.first;
+    }
+
+    std::istringstream in(contents);
+    std::string line;
+    unsigned int number = 0;
+    while (std::getline(in, line)) {
+        number++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        const auto first = line.find('\t');
+        const auto second = first == std::string::npos ? first : line.find('\t', first + 1);
+        if (second == std::string::npos) {
+            std::cerr << "import_waves() with \"" << wave_file << "\" line " << number << ": needs three fields\n";
+            return false;
+        }
+        const auto kind = line.substr(0, first);
+        const char *key = line.data() + first + 1;
+        const char *key_end = line.data() + second;
+        const char *value = line.data() + second + 1;
+        const char *value_end = line.data() + line.size();
+
+        int id;
+        int wave;
+        float seconds;
+        bool ok;
+        if (kind == "wave") {
+            ok = parse_int(key, key_end, wave) && wave >= 0 && parse_seconds(value, value_end, seconds);
+            if (ok) {
+                if (static_cast<std::size_t>(wave) >= waves.offsets.size()) {
+                    waves.offsets.resize(wave + 1, 0);
+                }
+                waves.offsets[wave] = seconds;
+            }
+        } else if (kind == "team") {
+            auto team = initials.find(std::string(key, key_end));
+            ok = team != initials.end() && parse_int(value, value_end, wave) && wave >= 0;
+            if (ok) {
+                waves.team_waves[team->second] = wave;
+            }
+        } else if (kind == "runner") {
+            ok = parse_int(key, key_end, id) && parse_int(value, value_end, wave) && wave >= 0;
+            if (ok) {
+                waves.runner_waves[id] = wave;
+            }
+        } else if (kind == "offset") {
+            ok = parse_int(key, key_end, id) && parse_seconds(value, value_end, seconds);
+            if (ok) {
+                waves.runner_offsets[id] = seconds;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "import_waves() with \"" << wave_file << "\" line " << number << ": \""
+                << line << "\" isn't a wave, team, runner or offset\n";
+            return false;
+        }
+    }
+
+    for (auto &entry : waves.team_waves) {
+        if (entry.second >= waves.offsets.size()) {
+            std::cerr << "import_waves() with \"" << wave_file << "\": no wave " << entry.second << "\n";
+            return false;
+        }
+    }
+    for (auto &entry : waves.runner_waves) {
+        if (entry.second >= waves.offsets.size()) {
+            std::cerr << "import_waves() with \"" << wave_file << "\": no wave " << entry.second << "\n";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef WAVES_HPP
+#define WAVES_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "wildcat.hpp"
+
+// Wave starts. The timer runs from the first gun; a runner's net time is
+// the timer value less their wave's offset. A runner's own offset beats
+// their wave, and a wave given for the runner beats their team's.
+struct Waves {
+    std::vector<float> offsets; // seconds after the first gun, per wave
+    std::map<TeamId, unsigned int> team_waves;
+    std::map<RunnerId, unsigned int> runner_waves;
+    std::map<RunnerId, float> runner_offsets;
+};
+
+// Net times by column, one entry per finish in timer order. Finishes are
+// grouped into slots, one per wave and then one per runner with their own
+// offset. Within a slot, timer order is net order, so ranking after an
+// offset change merges the slots rather than sorting everything again.
+struct NetTimes {
+    std::vector<RunnerId> runners;
+    std::vector<float> gun;
+    std::vector<float> offset;
+    std::vector<float> net;
+    std::vector<float> slot_offsets;
+    std::vector<std::vector<std::uint32_t>> slots;
+    std::vector<std::uint32_t> slot_of;
+    std::vector<std::uint32_t> order; // finish indexes by net time
+    std::vector<std::uint32_t> moved; // slots offset since the last ranking
+};
+
+void assign_waves(const Waves &waves, const Rosters &rosters,
+    const std::vector<float> &times, const std::vector<RunnerId> &barcodes, NetTimes &net_times);
+
+// A correction to one wave's offset; only that wave's finishes are touched
+// before compute_net_times() and rank_net_times() run again. With one
+// wave moved, ranking is a single merge of it back into the others.
+void set_wave_offset(Waves &waves, NetTimes &net_times, unsigned int wave, float seconds);
+
+void compute_net_times(NetTimes &net_times);
+void rank_net_times(NetTimes &net_times);
+
+// finishes in net time order, timed by net time, ready for score()
+void net_finishes(const NetTimes &net_times, Finishes &finishes);
+
+// Records, tab separated:
+//   wave    <wave>      <offset seconds>
+//   team    <initials>  <wave>
+//   runner  <bib>       <wave>
+//   offset  <bib>       <offset seconds>
+bool import_waves(const std::string &wave_file, const Teams &teams, Waves &waves);
+
+#endif
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "parse.hpp"
+#include "waves.hpp"
+
+// waves-bench [finishes]
+//
+// Times net-time scoring on a generated wave-start race of `finishes`
+// runners (20000 by default) in four waves, some with their own offset:
+// the whole assignment, the net-time pass against a plain loop, and a
+// one-wave offset correction with its re-ranking. The net times must
+// match the plain loop's, or the bench fails. Every figure is the best of
+// a few warm runs.
+
+static const int runs = 20;
+
+template <typename F>
+static double best_ms(F f) {
+    double best = 1e300;
+    for (auto i = 0; i < runs; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto took = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, took);
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    const unsigned int finishes = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+    Rosters rosters;
+    Waves waves;
+    waves.offsets = { 0, 60, 120, 180 };
+    const unsigned int team_count = 200;
+    for (TeamId team_id = 0; team_id < static_cast<TeamId>(team_count); team_id++) {
+        waves.team_waves[team_id] = team_id % waves.offsets.size();
+    }
+    std::mt19937 random(42);
+    std::vector<float> times;
+    std::vector<RunnerId> barcodes;
+    for (unsigned int i = 0; i < finishes; i++) {
+        const RunnerId runner_id = 1000 + i;
+        const TeamId team_id = random() % team_count;
+        rosters.runner_to_team[runner_id] = team_id;
+        rosters.team_to_runners[team_id].push_back(runner_id);
+        if (i % 100 == 0) {
+            waves.runner_offsets[runner_id] = (random() % 2400) / 10.0f;
+        }
+        barcodes.push_back(runner_id);
+        times.push_back(900 + i * 0.05f);
+    }
+    std::shuffle(barcodes.begin(), barcodes.end(), random);
+
+    NetTimes net_times;
+    const auto assign_ms = best_ms([&] () { assign_waves(waves, rosters, times, barcodes, net_times); });
+    const auto net_ms = best_ms([&] () { compute_net_times(net_times); });
+    std::vector<float> plain(net_times.gun.size());
+    const auto plain_ms = best_ms([&] () {
+        const auto *gun = net_times.gun.data();
+        const auto *offset = net_times.offset.data();
+        auto *net = plain.data();
+        // the loop compute_net_times() used to be; -O2 leaves it scalar
+        for (std::size_t i = 0; i < plain.size(); i++) {
+            net[i] = gun[i] - offset[i];
+        }
+    });
+    if (plain != net_times.net) {
+        std::cerr << "waves-bench: compute_net_times() differs from the plain loop\n";
+        return EXIT_FAILURE;
+    }
+    float shift = 0;
+    const auto correct_ms = best_ms([&] () {
+        shift += 0.5f;
+        set_wave_offset(waves, net_times, 2, 120 + shift);
+        compute_net_times(net_times);
+        rank_net_times(net_times);
+    });
+
+    std::cout << finishes << " finishes, " << (scan_isa() == ScanIsa::Avx2 ? "avx2" : scan_isa() == ScanIsa::Sse2 ? "sse2" : "scalar")
+        << " net pass\n"
+        << "assign      " << assign_ms << " ms\n"
+        << "net times   " << net_ms << " ms (plain loop " << plain_ms << " ms)\n"
+        << "correction  " << correct_ms << " ms (one wave moved, recomputed and re-ranked)\n";
+    return EXIT_SUCCESS;
+}
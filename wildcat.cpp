@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <map>
@@ -7,6 +9,9 @@
 #include <cmath>
 #include <experimental/optional>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include "parse.hpp"
 #include "wildcat.hpp"
 
 std::ostream &operator<<(std::ostream &os, const Class klass) {
@@ -60,7 +65,32 @@ bool operator==(const Squad &a, const Squad &b) {
     return a.score == b.score;
 }
 
-bool operator>(const Squad &a, const Squad &b) {
+template <typename TieBreaks>
+struct TieBreaker;
+
+template <unsigned int Position, unsigned int... Rest>
+struct TieBreaker<TieBreak<Position, Rest...>> {
+    static bool beats(const Squad &a, const Squad &b) {
+        const auto i = Position - 1;
+        if (a.places.size() > i &&
+            b.places.size() > i &&
+            a.places[i].place_number != b.places[i].place_number) {
+            return a.places[i].place_number < b.places[i].place_number;
+        }
+        return TieBreaker<TieBreak<Rest...>>::beats(a, b);
+    }
+};
+
+// last resort
+template <unsigned int Position>
+struct TieBreaker<TieBreak<Position>> {
+    static bool beats(const Squad &a, const Squad &b) {
+        return a.places[Position - 1].place_number < b.places[Position - 1].place_number;
+    }
+};
+
+template <typename Rules>
+bool beats(const Squad &a, const Squad &b) {
     if (a.score == 0 && b.score == 0) {
         return false;
     } else if (a.score > 0 && b.score == 0) {
@@ -71,27 +101,13 @@ bool operator>(const Squad &a, const Squad &b) {
         if (a.score != b.score) {
             return a.score < b.score;
         } else {
-            // 6th vs 6th
-            if (a.places.size() >= 6 &&
-                b.places.size() >= 6 &&
-                a.places[5].place_number != b.places[5].place_number) {
-                return a.places[5].place_number < b.places[5].place_number;
-            }
-
-            // 7th vs 7th
-            if (a.places.size() == 7 &&
-                b.places.size() == 7 &&
-                a.places[6].place_number != b.places[6].place_number) {
-                return a.places[6].place_number < b.places[6].place_number;
-            }
-
-            // last resort: 5th vs 5th
-            return a.places[4].place_number < b.places[4].place_number;
+            return TieBreaker<typename Rules::tie_breaks>::beats(a, b);
         }
     }
 }
 
-bool operator<(const Squad &a, const Squad &b) {
+template <typename Rules>
+bool trails(const Squad &a, const Squad &b) {
     if (b.score == 0 && a.score == 0) {
         return false;
     } else if (b.score > 0 && a.score == 0) {
@@ -99,10 +115,46 @@ bool operator<(const Squad &a, const Squad &b) {
     } else if (b.score == 0 && a.score > 0) {
         return false;
     } else {
-        return b > a;
+        return beats<Rules>(b, a);
     }
 }
 
+bool operator>(const Squad &a, const Squad &b) {
+    return beats<Nfhs>(a, b);
+}
+
+bool operator<(const Squad &a, const Squad &b) {
+    return trails<Nfhs>(a, b);
+}
+
+// sorta complex logic to update teams and rosters
+static void add_to_team(const std::string &initials, RunnerId runner_id, Rosters &rosters, Teams &teams) {
+    bool team_exists = false;
+    TeamId team_id; // will be assigned in for-each or following if-stmt
+    for (auto &team : teams) {
+        if (team.second.initials == initials) {
+            team_exists = true;
+            team_id = team.first;
+            break;
+        }
+    }
+
+    if (!team_exists) {
+        // add new team to teams
+        Team team;
+        team.initials = initials;
+        team_id = teams.size();
+
+        teams.insert(std::pair<TeamId, Team>(team_id, team));
+
+        // add new team into roster
+        rosters.team_to_runners.insert(std::pair<TeamId, std::vector<RunnerId>>(team_id, {}));
+    }
+
+    rosters.runner_to_team.insert(std::pair<RunnerId, TeamId>(runner_id, team_id));
+    rosters.team_to_runners[team_id].push_back(runner_id);
+}
+
 bool import_rosters_v1(const std::string &roster_file, Rosters &rosters, Teams &teams, Runners &runners) {
 
     rosters.runner_to_team.clear();
@@ -137,33 +189,7 @@ bool import_rosters_v1(const std::string &roster_file, Rosters &rosters, Teams &
         runner.name = token;
 
         std::getline(file, token, '\t'); // team
-        // sorta complex logic to update teams and rosters
-        {
-            bool team_exists = false;
-            TeamId team_id; // will be assigned in for-each or following if-stmt
-            for (auto &team : teams) {
-                if (team.second.initials == token) {
-                    team_exists = true;
-                    team_id = team.first;
-                    break;
-                }
-            }
-
-            if (!team_exists) {
-                // add new team to teams
-                Team team;
-                team.initials = token; 
-                team_id = teams.size();
-
-                teams.insert(std::pair<TeamId, Team>(team_id, team));
-              
-                // add new team into roster
-                rosters.team_to_runners.insert(std::pair<TeamId, std::vector<RunnerId>>(team_id, {}));
-            }
-
-            rosters.runner_to_team.insert(std::pair<RunnerId, TeamId>(runner_id, team_id));
-            rosters.team_to_runners[team_id].push_back(runner_id);
-        }
+        add_to_team(token, runner_id, rosters, teams);
 
         std::getline(file, token, '\t'); // klass
         try {
@@ -255,6 +281,161 @@ bool import_times_v1(const std::string &times_file, std::vector<float> &times) {
     return true;
 }
 
+struct Field {
+    const char *begin;
+    const char *end;
+};
+
+// Splits contents into tab separated records using the delimiter index and
+// hands each non-empty line to on_record. Missing trailing fields are empty.
+// `line` is the line number contents starts at.
+template <typename F>
+static bool for_each_record(const std::string &contents, unsigned int field_count, F on_record, unsigned int line = 1) {
+    std::vector<std::uint32_t> delims;
+    index_fields(contents.data(), contents.size(), delims);
+    delims.push_back(static_cast<std::uint32_t>(contents.size()));
+
+    const char *data = contents.data();
+    std::vector<Field> fields;
+    fields.reserve(field_count);
+    std::size_t start = 0;
+    for (auto delim : delims) {
+        const bool end_of_record = delim == contents.size() || data[delim] == '\n';
+        if (fields.size() < field_count) {
+            fields.push_back({ data + start, data + delim });
+        } else {
+            fields.back().end = data + delim;
+        }
+        start = delim + 1;
+        if (!end_of_record) {
+            continue;
+        }
+        const bool blank = fields.size() == 1 && (fields[0].begin == fields[0].end ||
+            (fields[0].end - fields[0].begin == 1 && *fields[0].begin == '\r'));
+        if (!blank) {
+            while (fields.size() < field_count) {
+                fields.push_back({ data + delim, data + delim });
+            }
+            if (!on_record(fields, line)) {
+                return false;
+            }
+        }
+        fields.clear();
+        line++;
+    }
+    return true;
+}
+
+bool import_rosters_v2(const std::string &roster_file, Rosters &rosters, Teams &teams, Runners &runners) {
+
+    rosters.runner_to_team.clear();
+    rosters.team_to_runners.clear();
+    teams.clear();
+    runners.clear();
+
+    std::string contents;
+    if (!read_file(roster_file, contents)) {
+        std::cerr << "import_rosters_v2(): No file \"" << roster_file << "\"\n";
+        return false;
+    }
+
+    return for_each_record(contents, 5, [&] (const std::vector<Field> &fields, unsigned int line) {
+        RunnerId runner_id;
+        Runner runner;
+
+        if (!parse_int(fields[0].begin, fields[0].end, runner_id)) {
+            std::cerr << "import_rosters_v2() with \"" << roster_file << "\" line " << line << ": \""
+                << std::string(fields[0].begin, fields[0].end) << "\" must be a integer.\n";
+            return false;
+        }
+
+        runner.name.assign(fields[1].begin, fields[1].end);
+
+        add_to_team(std::string(fields[2].begin, fields[2].end), runner_id, rosters, teams);
+
+        int grade;
+        if (parse_int(fields[3].begin, fields[3].end, grade)) {
+            switch (grade) {
+            case 9: runner.klass = Class::Fr; break;
+            case 10: runner.klass = Class::So; break;
+            case 11: runner.klass = Class::Jr; break;
+            case 12: runner.klass = Class::Sr; break;
+            default:
+                std::cerr << "import_rosters_v2() with \"" << roster_file << "\" line " << line << ": \""
+                    << grade << "\" must be between [9,12]\n";
+                return false;
+            }
+        }
+
+        const auto gender = fields[4].begin < fields[4].end ? *fields[4].begin : '\0';
+        if (gender == 'G' || gender == 'g' || gender == 'F' || gender == 'f') {
+            runner.gender = Gender::F;
+        } else if (gender == 'B' || gender == 'b' || gender == 'M' || gender == 'm') {
+            runner.gender = Gender::M;
+        }
+
+        runners.insert(std::pair<RunnerId, Runner>(runner_id, runner));
+        return true;
+    });
+}
+
+bool import_barcodes_v2(const std::string &barcode_file, std::vector<RunnerId> &barcodes) {
+
+    barcodes.clear();
+
+    std::string contents;
+    if (!read_file(barcode_file, contents)) {
+        std::cerr << "import_barcodes_v2(): No file \"" << barcode_file << "\"\n";
+        return false;
+    }
+
+    return append_barcodes_v2(contents, barcode_file, 1, barcodes);
+}
+
+bool append_barcodes_v2(const std::string &contents, const std::string &barcode_file, unsigned int line,
+        std::vector<RunnerId> &barcodes) {
+
+    return for_each_record(contents, 1, [&] (const std::vector<Field> &fields, unsigned int line) {
+        RunnerId runner_id;
+        if (!parse_int(fields[0].begin, fields[0].end, runner_id)) {
+            std::cerr << "import_barcodes_v2() with \"" << barcode_file << "\" line " << line << ": \""
+                << std::string(fields[0].begin, fields[0].end) << "\" Not a number\n";
+            return false;
+        }
+        barcodes.push_back(runner_id);
+        return true;
+    }, line);
+}
+
+bool import_times_v2(const std::string &times_file, std::vector<float> &times) {
+
+    times.clear();
+
+    std::string contents;
+    if (!read_file(times_file, contents)) {
+        std::cerr << "import_times_v2(): No file \"" << times_file << "\"\n";
+        return false;
+    }
+
+    return append_times_v2(contents, times_file, 1, times);
+}
+
+bool append_times_v2(const std::string &contents, const std::string &times_file, unsigned int line,
+        std::vector<float> &times) {
+
+    // the timer exports seven columns; the last one is the time stamp
+    return for_each_record(contents, 7, [&] (const std::vector<Field> &fields, unsigned int line) {
+        float seconds;
+        if (!parse_seconds(fields[6].begin, fields[6].end, seconds)) {
+            std::cerr << "import_times_v2() with \"" << times_file << "\" line " << line << ": \""
+                << std::string(fields[6].begin, fields[6].end) << "\" Not a timestamp\n";
+            return false;
+        }
+        times.push_back(seconds);
+        return true;
+    }, line);
+}
+
 void make_finishes(const std::vector<float> &times, const std::vector<RunnerId> &barcodes, Finishes &finishes) {
 
     finishes.clear();
@@ -264,6 +445,7 @@ void make_finishes(const std::vector<float> &times, const std::vector<RunnerId>
     }
 }
 
+template <typename Rules>
 void separate_combined_heat(const Rosters &rosters, const Finishes &all, Finishes &varsity, Finishes &jv) {
 
     varsity.clear();
@@ -272,11 +454,17 @@ void separate_combined_heat(const Rosters &rosters, const Finishes &all, Finishe
     std::map<TeamId, unsigned int> finished;
 
     for (auto &finish : all) {
-        auto team_id = rosters.runner_to_team.at(finish.runner_id);
+        auto team = rosters.runner_to_team.find(finish.runner_id);
+        if (team == rosters.runner_to_team.end()) {
+            // places, but counts toward no team's varsity
+            varsity.push_back(finish);
+            continue;
+        }
+        const auto team_id = team->second;
         if (finished.count(team_id) == 0) {
             finished[team_id] = 0;
         }
-        if (finished[team_id] < 7) {
+        if (finished[team_id] < Rules::displacers) {
             finished[team_id]++;
             varsity.push_back(finish);
             continue;
@@ -297,92 +485,115 @@ bool operator<(const Result &a, const Result &b) {
     return a.squad < b.squad;
 }
 
+// Scoring runs over flat arrays indexed by a team's position in `teams`.
+// The first pass looks each finisher's team up once and numbers them
+// within it; the second pass, knowing which squads are full, hands out
+// scorer numbers, squad scores and squad times in finish order without
+// touching a map again. Teams are then ordered by a heap of indexes,
+// pushed in `teams` order, so equal squads come out as they always have.
+template <typename Rules>
 void score_race(const Runners &runners, const Teams &teams, const Rosters &rosters, Finishes &finishes, Results &results) {
+    (void)runners;
+    static const std::uint32_t no_team = ~std::uint32_t(0);
 
-    results.clear();
-
-    Squads squads;
-
+    std::vector<TeamId> team_ids;
+    team_ids.reserve(teams.size());
     for (auto &team : teams) {
-        squads.insert(std::pair<TeamId, Squad>(team.first, {0, Time(0), {}}));
+        team_ids.push_back(team.first);
     }
-
-    // Fill up squads
-    for (unsigned int i = 0; i < finishes.size(); i++) {
-        auto const &finish = finishes[i];
-        auto team_id = rosters.runner_to_team.at(finish.runner_id);
-        
-        if (squads.count(team_id)) {
-            const auto place_number = i + 1;
-            squads[team_id].places.push_back({
-                .runner_id = finish.runner_id,
-                .place_number = place_number,
+    const bool contiguous = team_ids.empty() ||
+        static_cast<std::size_t>(team_ids.back() - team_ids.front()) + 1 == team_ids.size();
+    auto team_index = [&] (TeamId team_id) {
+        if (contiguous) {
+            const auto i = static_cast<std::size_t>(team_id - team_ids.front());
+            return i < team_ids.size() ? static_cast<std::uint32_t>(i) : no_team;
+        }
+        auto found = std::lower_bound(team_ids.begin(), team_ids.end(), team_id);
+        return found != team_ids.end() && *found == team_id ? static_cast<std::uint32_t>(found - team_ids.begin()) : no_team;
+    };
+
+    std::vector<Squad> squads(team_ids.size(), Squad{ 0, Time(0), {} });
+    std::vector<std::uint32_t> finish_team(finishes.size());
+    std::vector<std::uint32_t> finish_position(finishes.size());
+
+    for (std::size_t i = 0; i < finishes.size(); i++) {
+        auto team = rosters.runner_to_team.find(finishes[i].runner_id);
+        const auto t = team == rosters.runner_to_team.end() || team_ids.empty() ? no_team : team_index(team->second);
+        finish_team[i] = t;
+        if (t != no_team) {
+            auto &places = squads[t].places;
+            finish_position[i] = static_cast<std::uint32_t>(places.size());
+            places.push_back({
+                .runner_id = finishes[i].runner_id,
+                .place_number = static_cast<unsigned int>(i + 1),
             });
         }
     }
 
-    // Sum times
-    for (auto &squad : squads) {
-        if (squad.second.places.size() < 5) {
-            continue;
-        }
-        for (auto i = 0; i < 5; i++) {
-            const auto &place_number = squad.second.places[i].place_number;
-            squad.second.time = squad.second.time + finishes[place_number - 1].time;
-        }
-    }
-   
-    // Calc score 
-    std::set<RunnerId> scorers;
-    for (auto &squad : squads) {
-        if (squad.second.places.size() < 5) {
+    unsigned int score_num = 1;
+    for (std::size_t i = 0; i < finishes.size(); i++) {
+        const auto t = finish_team[i];
+        const auto position = finish_position[i];
+        if (t == no_team || position >= Rules::displacers) {
             continue;
         }
-        for (auto i = 0; i < 7 && i < squad.second.places.size(); i++) {
-            scorers.insert(squad.second.places[i].runner_id);
-        }
-    }
-    unsigned int score_num = 1;
-    for (auto &finish : finishes) {
-        if (!scorers.count(finish.runner_id)) {
+        auto &squad = squads[t];
+        if (squad.places.size() < Rules::minimum_squad) {
             continue;
         }
-        finish.score = score_num;
-
-        // add score to squad
-        auto &squad = squads.at(rosters.runner_to_team.at(finish.runner_id));
-        for (auto i = 0; i < 5; i++) {
-            auto &place = squad.places.at(i);
-            if (place.runner_id == finish.runner_id) {
-                squad.score += score_num;
-                break;
-            }
+        finishes[i].score = score_num;
+        if (position < Rules::scorers) {
+            squad.score += score_num;
+            squad.time = squad.time + finishes[i].time;
         }
-
         score_num++;
     }
 
-    std::priority_queue<Result> queue;
-    for (auto &squad : squads) {
-        queue.push({
-            .place = 0,
-            .team_id = squad.first,
-            .squad = squad.second,
-        });
+    auto trailing = [&] (std::uint32_t a, std::uint32_t b) {
+        return trails<Rules>(squads[a], squads[b]);
+    };
+    std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, decltype(trailing)> queue(trailing);
+    for (std::uint32_t t = 0; t < squads.size(); t++) {
+        queue.push(t);
     }
 
+    results.clear();
+    results.reserve(squads.size());
     unsigned int place = 1;
     while (queue.size()) {
-        auto result = queue.top();
-        result.place = place;
-        if (result.squad.score != 0) {
+        const auto t = queue.top();
+        queue.pop();
+        results.push_back({
+            .place = place,
+            .team_id = team_ids[t],
+            .squad = std::move(squads[t]),
+        });
+        if (results.back().squad.score != 0) {
             place++;
         }
-        results.push_back(result);
-        queue.pop();
     }
 }
 
+// scorers, then displacers in parentheses: " 1 4 9 12 20 (31 40)"
+template <typename Rules>
+static void output_places(std::ostream &os, const Squad &squad) {
+    for (unsigned int i = 0; i < Rules::scorers && i < squad.places.size(); i++) {
+        os << ' ' << squad.places[i].place_number;
+    }
+
+    if (Rules::displacers > Rules::scorers && squad.places.size() > Rules::scorers) {
+        os << " (";
+        for (unsigned int i = Rules::scorers; i < Rules::displacers && i < squad.places.size(); i++) {
+            if (i > Rules::scorers) {
+                os << ' ';
+            }
+            os << squad.places[i].place_number;
+        }
+        os << ")";
+    }
+}
+
+template <typename Rules>
 void print_results(Results &results, Teams &teams) {
     for (auto &result : results) {
         std::cout << result.place;
@@ -394,26 +605,7 @@ void print_results(Results &results, Teams &teams) {
         std::cout << result.squad.time;
         std::cout << " -";
 
-        for (auto i = 0; i < 5 && i < result.squad.places.size(); i++) {
-            std::cout << ' ' << result.squad.places[i].place_number;
-        }
-   
-        if (result.squad.places.size() >= 6) { 
-            std::cout << " (";
-        }
-
-        if (5 < result.squad.places.size()) {
-            std::cout << result.squad.places[5].place_number;
-        }
-
-        if (6 < result.squad.places.size()) {
-            std::cout << ' ';
-            std::cout << result.squad.places[6].place_number;
-        }
-
-        if (result.squad.places.size() >= 6) { 
-            std::cout << ")";
-        }
+        output_places<Rules>(std::cout, result.squad);
 
         std::cout << '\n';
     }
@@ -487,8 +679,7 @@ void Heat::set_combined() {
     tag = Tag::Combined;
 }
 
-void output_results(std::ostream &os,
-        const Rosters &rosters, const Teams &teams, const Runners &runners, const Finishes &finishes, const Results &results) {
+void output_individuals_header(std::ostream &os) {
     os << '\n';
     os << "RACE #_______________________ DIV #___________________________\n";
     os << '\n';
@@ -497,94 +688,114 @@ void output_results(std::ostream &os,
     os << '\n';
     os << "Place  Team             Name                              Grade  Time        Score\n"; 
     os << "----------------------------------------------------------------------------------\n";
+}
 
-    auto place = 1;
-    for (auto &finish : finishes) {
-        std::stringstream ss;
-        auto extend = [&] (unsigned int limit) {
-            for (auto i = ss.str().length(); i < limit; i++) {
-                ss << ' ';
-            }
-        };
-        //
-        ss << place;
-        extend(7);
-        ss << teams.at(rosters.runner_to_team.at(finish.runner_id)).initials;
-        extend(24);
-        ss << runners.at(finish.runner_id).name;
-        extend(58);
-        auto klass = runners.at(finish.runner_id).klass;
-        if (klass) {
-            ss << *klass;
+void output_individual(std::ostream &os, unsigned int place,
+        const Rosters &rosters, const Teams &teams, const Runners &runners, const Finish &finish) {
+    std::stringstream ss;
+    auto extend = [&] (unsigned int limit) {
+        for (auto i = static_cast<unsigned int>(ss.tellp()); i < limit; i++) {
+            ss << ' ';
         }
-        extend(65);
-        ss << finish.time;
-        extend(77);
-        if (finish.score) {
-            ss << finish.score;
+    };
+    //
+    ss << place;
+    extend(7);
+    // blank columns for a finisher the roster doesn't know
+    auto team = rosters.runner_to_team.find(finish.runner_id);
+    if (team != rosters.runner_to_team.end()) {
+        auto found = teams.find(team->second);
+        if (found != teams.end()) {
+            ss << found->second.initials;
         }
-        //
-        place++;
-        os << ss.str();
-        os << '\n';
     }
- 
+    extend(24);
+    auto runner = runners.find(finish.runner_id);
+    if (runner != runners.end()) {
+        ss << runner->second.name;
+        extend(58);
+        if (runner->second.klass) {
+            ss << *runner->second.klass;
+        }
+    }
+    extend(65);
+    ss << finish.time;
+    extend(77);
+    if (finish.score) {
+        ss << finish.score;
+    }
+    //
+    os << ss.str();
+    os << '\n';
+}
+
+void output_team_scores_header(std::ostream &os) {
     os << "==================================================================================\n";
     os << '\n';
     os << '\n';
     os << "TEAM SCORES\n";
     os << "==================================================================================\n";
     os << '\n';
+}
 
-    for (auto &result : results) {
-        std::stringstream ss;
-        //
-        ss << '#';
-        ss << result.place;
-        ss << ' ';
-        ss << teams.at(result.team_id).initials;
-        ss << "\n   ";
+template <typename Rules>
+void output_team_score(std::ostream &os, const Teams &teams, const Result &result) {
+    std::stringstream ss;
+    //
+    ss << '#';
+    ss << result.place;
+    ss << ' ';
+    ss << teams.at(result.team_id).initials;
+    ss << "\n   ";
+
+    output_places<Rules>(ss, result.squad);
+
+    if (result.squad.score) {
+        ss << " = ";
+        ss << result.squad.score;
+    }
 
-        for (auto i = 0; i < 5 && i < result.squad.places.size(); i++) {
-            ss << ' ' << result.squad.places[i].place_number;
-        }
-   
-        if (result.squad.places.size() >= 6) { 
-            ss << " (";
-        }
+    if (result.squad.score) {
+        ss << "\n    ";
+        ss << result.squad.time;
+    }
 
-        if (5 < result.squad.places.size()) {
-            ss << result.squad.places[5].place_number;
-        }
+    //
+    ss << '\n';
+    ss << '\n';
+    os << ss.str();
+}
 
-        if (6 < result.squad.places.size()) {
-            ss << ' ';
-            ss << result.squad.places[6].place_number;
-        }
+void output_results_footer(std::ostream &os) {
+    os << '\n';
+    os << "==================================================================================\n";
+    os << '\n';
+}
 
-        if (result.squad.places.size() >= 6) { 
-            ss << ")";
-        }
+void output_signature(std::ostream &os) {
+    os << '\n';
+    os << "			Wildcat Timing & Scoring System © 2010-2015\n";
+    os << '\n';
+}
 
-        if (result.squad.score) {
-            ss << " = ";
-            ss << result.squad.score;
-        }
+template <typename Rules>
+void output_results(std::ostream &os,
+        const Rosters &rosters, const Teams &teams, const Runners &runners, const Finishes &finishes, const Results &results) {
+    output_individuals_header(os);
 
-        if (result.squad.score) {
-            ss << "\n    ";
-            ss << result.squad.time;
-        }
+    auto place = 1;
+    for (auto &finish : finishes) {
+        output_individual(os, place, rosters, teams, runners, finish);
+        place++;
+    }
+ 
+    output_team_scores_header(os);
 
-        //
-        ss << '\n';
-        ss << '\n';
-        os << ss.str();
+    for (auto &result : results) {
+        output_team_score<Rules>(os, teams, result);
     }
 
-    os << '\n';
-    os << "==================================================================================\n";
-    os << '\n';
+    output_results_footer(os);
 }
 
 std::ostream &operator<<(std::ostream &os, const Wildcat &w) {
@@ -599,30 +810,161 @@ std::ostream &operator<<(std::ostream &os, const Wildcat &w) {
         output_results(os, w.rosters, w.teams, w.runners, *w.heat.combined.jv_finishes, *w.heat.combined.jv_results);
         break;
     }
-    os << '\n';
-    os << "			Wildcat Timing & Scoring System © 2010-2015\n";
-    os << '\n';
+    output_signature(os);
     return os;
 }
 
-void score(Wildcat &w) {
+template <typename Rules>
+bool validate(const Wildcat &w, Validation &validation) {
+
+    validation = Validation();
+
+    // Bib numbers are usually dense, so one slot per id in the roster's
+    // range answers "known?" and one bit "seen?". One outlying bib would make that range huge, so past
+    // a few bits per runner a hash set does it instead.
+    const auto &runner_to_team = w.rosters.runner_to_team;
+    long long first_id = 0;
+    long long span = 0;
+    if (!runner_to_team.empty()) {
+        first_id = runner_to_team.begin()->first;
+        span = static_cast<long long>(runner_to_team.rbegin()->first) - first_id + 1;
+    }
+    const bool dense = span <= 4 * static_cast<long long>(runner_to_team.size()) + 64;
+    std::vector<bool> seen(dense ? static_cast<std::size_t>(span) : 0, false);
+    std::unordered_set<RunnerId> seen_sparse;
+    auto first_sighting = [&] (RunnerId runner_id) {
+        if (!dense) {
+            return seen_sparse.insert(runner_id).second;
+        }
+        const auto bit = static_cast<std::size_t>(runner_id - first_id);
+        const bool first = !seen[bit];
+        seen[bit] = true;
+        return first;
+    };
+
+    // Scoring looks runners and teams up unchecked, so a runner is only
+    // known if the roster has them, their team and the team's entry. That's
+    // settled once per roster entry rather than per finish: a known
+    // runner's slot holds their team's index plus one, an unknown one 0.
+    std::map<TeamId, unsigned int> team_index;
+    std::vector<unsigned int> known(dense ? static_cast<std::size_t>(span) : 0, 0);
+    std::unordered_map<RunnerId, unsigned int> known_sparse;
+    for (auto &entry : runner_to_team) {
+        if (!w.runners.count(entry.first) || !w.teams.count(entry.second)) {
+            continue;
+        }
+        const auto slot = team_index.insert({ entry.second, team_index.size() }).first->second + 1;
+        if (dense) {
+            known[static_cast<std::size_t>(entry.first - first_id)] = slot;
+        } else {
+            known_sparse[entry.first] = slot;
+        }
+    }
+    auto known_slot = [&] (RunnerId runner_id) -> unsigned int {
+        if (!dense) {
+            const auto found = known_sparse.find(runner_id);
+            return found == known_sparse.end() ? 0 : found->second;
+        }
+        const auto bit = static_cast<long long>(runner_id) - first_id;
+        return bit >= 0 && bit < span ? known[static_cast<std::size_t>(bit)] : 0;
+    };
+
+    std::vector<unsigned int> finished(team_index.size(), 0);
+    for (std::size_t i = 0; i < w.finishes.size(); i++) {
+        const auto runner_id = w.finishes[i].runner_id;
+        const auto slot = known_slot(runner_id);
+        if (!slot) {
+            validation.unknown.push_back(i);
+            continue;
+        }
+        if (!first_sighting(runner_id)) {
+            validation.duplicates.push_back(i);
+            continue;
+        }
+        finished[slot - 1]++;
+    }
+
+    if (w.barcodes.size() > w.finishes.size()) {
+        validation.missing_times = w.barcodes.size() - w.finishes.size();
+    }
+
+    for (auto &team : team_index) {
+        const auto count = finished[team.second];
+        if (count && count < Rules::minimum_squad) {
+            validation.short_teams.push_back(team.first);
+        }
+    }
+
+    return validation.unknown.empty() && validation.duplicates.empty();
+}
+
+template <typename Rules>
+bool score(Wildcat &w) {
+    Validation validation;
+    const auto valid = validate<Rules>(w, validation);
+
+    for (auto i : validation.unknown) {
+        std::cerr << "score(): finish #" << i + 1 << " runner \"" << w.finishes[i].runner_id << "\" is not on the roster\n";
+    }
+    for (auto i : validation.duplicates) {
+        std::cerr << "score(): finish #" << i + 1 << " runner \"" << w.finishes[i].runner_id << "\" already finished\n";
+    }
+
+    if (!valid) {
+        return false;
+    }
+
     switch (w.heat.tag) {
     case Heat::Tag::Single:
         *w.heat.single.finishes = w.finishes;
         break;
     case Heat::Tag::Combined:
-        separate_combined_heat(w.rosters, w.finishes,
+        separate_combined_heat<Rules>(w.rosters, w.finishes,
             *w.heat.combined.varsity_finishes, *w.heat.combined.jv_finishes);
         break;
     }
 
     switch (w.heat.tag) {
     case Heat::Tag::Single:
-        score_race(w.runners, w.teams, w.rosters, *w.heat.single.finishes, *w.heat.single.results);
+        score_race<Rules>(w.runners, w.teams, w.rosters, *w.heat.single.finishes, *w.heat.single.results);
         break;
     case Heat::Tag::Combined:
-        score_race(w.runners, w.teams, w.rosters, *w.heat.combined.varsity_finishes, *w.heat.combined.varsity_results);
-        score_race(w.runners, w.teams, w.rosters, *w.heat.combined.jv_finishes, *w.heat.combined.jv_results);
+        score_race<Rules>(w.runners, w.teams, w.rosters, *w.heat.combined.varsity_finishes, *w.heat.combined.varsity_results);
+        score_race<Rules>(w.runners, w.teams, w.rosters, *w.heat.combined.jv_finishes, *w.heat.combined.jv_results);
         break;
     }
+
+    return true;
 }
+
+// Not errors, and the normal state mid-race, so score() leaves them to
+// whoever scores a finished race.
+template <typename Rules>
+void output_warnings(std::ostream &os, const Wildcat &w) {
+    Validation validation;
+    validate<Rules>(w, validation);
+    if (validation.missing_times) {
+        os << validation.missing_times << " barcode(s) have no time\n";
+    }
+    for (auto team_id : validation.short_teams) {
+        os << "team \"" << w.teams.find(team_id)->second.initials << "\" has fewer than "
+            << Rules::minimum_squad << " finishers and doesn't score\n";
+    }
+}
+
+#define INSTANTIATE_SCORING(Rules) \
+    template bool beats<Rules>(const Squad &a, const Squad &b); \
+    template bool trails<Rules>(const Squad &a, const Squad &b); \
+    template void separate_combined_heat<Rules>(const Rosters &rosters, const Finishes &all, Finishes &varsity, Finishes &jv); \
+    template void score_race<Rules>(const Runners &runners, const Teams &teams, const Rosters &rosters, Finishes &finishes, Results &results); \
+    template void print_results<Rules>(Results &results, Teams &teams); \
+    template void output_results<Rules>(std::ostream &os, \
+        const Rosters &rosters, const Teams &teams, const Runners &runners, const Finishes &finishes, const Results &results); \
+    template void output_team_score<Rules>(std::ostream &os, const Teams &teams, const Result &result); \
+    template bool validate<Rules>(const Wildcat &w, Validation &validation); \
+    template void output_warnings<Rules>(std::ostream &os, const Wildcat &w); \
+    template bool score<Rules>(Wildcat &w);
+
+INSTANTIATE_SCORING(Nfhs)
+INSTANTIATE_SCORING(FourScorer)
+INSTANTIATE_SCORING(SixDisplacer)
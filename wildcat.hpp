@@ -13,6 +13,7 @@
 #include <tuple>
 #include <set>
 #include <memory>
+#include "rules.hpp"
 #include "time.hpp"
 
 using std::experimental::optional;
@@ -65,6 +66,11 @@ bool operator==(const Squad &a, const Squad &b);
 bool operator>(const Squad &a, const Squad &b);
 bool operator<(const Squad &a, const Squad &b);
 
+// beats: a places ahead of b. trails: a places behind b. The operators
+// above are the Nfhs rules.
+template <typename Rules> bool beats(const Squad &a, const Squad &b);
+template <typename Rules> bool trails(const Squad &a, const Squad &b);
+
 using Squads = std::map<TeamId, Squad>;
 
 using Runners = std::map<RunnerId, Runner>;
@@ -72,6 +78,8 @@ using Runners = std::map<RunnerId, Runner>;
 struct Rosters {
     std::map<RunnerId, TeamId> runner_to_team;
     std::map<TeamId, std::vector<RunnerId>> team_to_runners;
+    // past every team id a reload has handed out, teams since gone included
+    TeamId next_team_id = 0;
 };
 
 struct Finish {
@@ -134,16 +142,55 @@ struct Wildcat {
 
 std::ostream &operator<<(std::ostream &os, const Wildcat &w);
 
+// Problems found by validate(). Indexes refer to Wildcat::finishes.
+struct Validation {
+    std::vector<std::size_t> unknown;
+    std::vector<std::size_t> duplicates;
+    std::size_t missing_times = 0;
+    std::vector<TeamId> short_teams; // finished someone, but too few to score
+};
+
 bool import_rosters_v1(const std::string &roster_file, Rosters &rosters, Teams &teams, Runners &runners);
 bool import_barcodes_v1(const std::string &barcode_file, std::vector<RunnerId> &barcodes);
 bool import_times_v1(const std::string &times_file, std::vector<float> &times);
+bool import_rosters_v2(const std::string &roster_file, Rosters &rosters, Teams &teams, Runners &runners);
+bool import_barcodes_v2(const std::string &barcode_file, std::vector<RunnerId> &barcodes);
+bool import_times_v2(const std::string &times_file, std::vector<float> &times);
+// The v2 parsers on part of a file, appending rather than replacing: for
+// reading a file as it grows. `line` is the file's line contents starts at.
+bool append_barcodes_v2(const std::string &contents, const std::string &barcode_file, unsigned int line,
+    std::vector<RunnerId> &barcodes);
+bool append_times_v2(const std::string &contents, const std::string &times_file, unsigned int line,
+    std::vector<float> &times);
 void make_finishes(const std::vector<float> &times, const std::vector<RunnerId> &barcodes, Finishes &finishes);
+
+// Scoring is instantiated for the formats in rules.hpp.
+template <typename Rules = Nfhs>
 void separate_combined_heat(const Rosters &rosters, const Finishes &all, Finishes &varsity, Finishes &jv);
+template <typename Rules = Nfhs>
 void score_race(const Runners &runners, const Teams &teams, const Rosters &rosters, Finishes &finishes, Results &results);
+template <typename Rules = Nfhs>
 void print_results(Results &results, Teams &teams);
 
+template <typename Rules = Nfhs>
 void output_results(std::ostream &os,
-    const Rosters &rosters, const Teams &teams, const Runners &runners, const Results &results);
-void score(Wildcat &w);
+    const Rosters &rosters, const Teams &teams, const Runners &runners, const Finishes &finishes, const Results &results);
+// The pieces output_results() is made of, one row or block at a time.
+void output_individuals_header(std::ostream &os);
+void output_individual(std::ostream &os, unsigned int place,
+    const Rosters &rosters, const Teams &teams, const Runners &runners, const Finish &finish);
+void output_team_scores_header(std::ostream &os);
+template <typename Rules = Nfhs>
+void output_team_score(std::ostream &os, const Teams &teams, const Result &result);
+void output_results_footer(std::ostream &os);
+void output_signature(std::ostream &os);
+
+template <typename Rules = Nfhs>
+bool validate(const Wildcat &w, Validation &validation);
+template <typename Rules = Nfhs>
+bool score(Wildcat &w);
+// barcodes without times and teams too short to score, once a race is over
+template <typename Rules = Nfhs>
+void output_warnings(std::ostream &os, const Wildcat &w);
 
 #endif